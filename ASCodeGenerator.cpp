@@ -1,7 +1,5 @@
 #include "ASCodeGenerator.h"
 #include "IntermediateCodeGenerator.h"
-#include <memory>
-#include <optional>
 
 char ASCodeGenerator::get_cmd_postfix(uint8_t size) {
 	switch (size) {
@@ -20,22 +18,14 @@ char ASCodeGenerator::get_cmd_postfix(uint8_t size) {
 	return size;
 }
 
-std::string ASCodeGenerator::asm_cmd(const IRCommand& command, const std::optional<ASMVal>& arg1, const std::optional<ASMVal>& arg2, uint8_t cmd_size) {
+std::string ASCodeGenerator::asm_cmd(const IRCommand& command, uint8_t cmd_size) {
 	std::string ret{as_cmds[command.type]};
+	auto [arg1, arg2, arg3]{command.args};
 	if (arg1.has_value()) {
-		auto get_sz = [](auto val) {
-			if (auto lhs{std::dynamic_pointer_cast<ASMValRegister>(val)}) {
-				return lhs->held_type->get_size();
-			} else {
-				return val->held_type->get_size();
-			}
-		};
 		uint8_t size{cmd_size};
 		if (cmd_size == 0) {
-			size = get_sz(arg1.value());
-			if (arg2.has_value()) {
-				size = std::min(size, get_sz(arg2.value()));
-			}
+			size = arg1.size();
+			if (arg2.has_value()) size = std::min(size, arg2.size());
 		}
 
 		ret += get_cmd_postfix(size);
@@ -43,52 +33,49 @@ std::string ASCodeGenerator::asm_cmd(const IRCommand& command, const std::option
 	return ret;
 }
 
-std::string ASCodeGenerator::asm_val_str(const ASMVal& val) {
-	if (auto reg{std::dynamic_pointer_cast<ASMValRegister>(val)}) {
-		std::string ret{};
-		if (reg->offset.has_value()) ret += std::to_string(reg->offset.value()) + "(";
-		else if (reg->dereferenced) ret += "(";
-
-		ret += "%" + as_registers[(size_t)reg->reg->name].sizes[reg->reg_size]; 
-
-		if (reg->offset.has_value()) ret += ")";
-		else if (reg->dereferenced) ret += ")";
-		return ret;
-	} else {
-		return "$" + std::dynamic_pointer_cast<ASMValNonRegister>(val)->value;
+std::string ASCodeGenerator::asm_val_str(const IRCommand& command, Operand val) {
+	switch (val.kind()) {
+		case OperandKind::REGISTER:
+			return "%" + as_registers[(size_t)val.reg_name()].sizes[val.size()];
+		case OperandKind::FRAME:
+			return std::to_string(val.id()) + "(%" + as_registers[(size_t)RegisterName::Base].sizes[SZ_R] + ")";
+		case OperandKind::INDIRECT:
+			return "(%" + as_registers[(size_t)val.reg_name()].sizes[SZ_R] + ")";
+		case OperandKind::SYMBOL:
+			return text(command, val) + "(%" + as_registers[(size_t)RegisterName::Instruction].sizes[SZ_R] + ")";
+		default:
+			return "$" + text(command, val);
 	}
 }
 
+std::string ASCodeGenerator::text(const IRCommand& command, Operand val) {
+	if (val.kind() == OperandKind::SYMBOL) return ir.symbols[val.id()];
+	uint64_t value{ir.immediates[val.id()]};
+	return (command.is_signed ? std::to_string((int64_t)value) : std::to_string(value));
+}
+
 std::string ASCodeGenerator::basic_translation(const IRCommand& command, uint8_t cmd_size) {
-	std::optional<ASMVal> arg1{get_first(command)};
-	std::optional<ASMVal> arg2{get_second(command)};
-	std::optional<ASMVal> arg3{get_third(command)};
+	auto [arg1, arg2, arg3]{command.args};
 
-	std::string ret{asm_cmd(command, arg1, arg2, cmd_size) + ' '};
+	std::string ret{asm_cmd(command, cmd_size) + ' '};
 
 	if (arg3.has_value()) {
-		if (!comp_asm_val(arg1.value(), arg2.value())) {
-			move(IRCommand{IRCommandType::MOVE, std::make_tuple(
-				arg1,
-				arg2,
-				std::nullopt
-			)});
-		}
+		if (arg1 != arg2) move(IRCommand{IRCommandType::MOVE, Condition::ALWAYS, command.is_signed, {arg1, arg2}});
 
-		ret += asm_val_str(arg3.value()) + ", " + asm_val_str(arg1.value());
+		ret += asm_val_str(command, arg3) + ", " + asm_val_str(command, arg1);
 	} else {
 		if (arg2.has_value()) {
-			ret += asm_val_str(arg2.value());
-			if (arg1.has_value()) ret += ", " + asm_val_str(arg1.value());
+			ret += asm_val_str(command, arg2);
+			if (arg1.has_value()) ret += ", " + asm_val_str(command, arg1);
 		} else {
-			ret += asm_val_str(arg1.value());
+			ret += asm_val_str(command, arg1);
 		}
 	}
 	return ret;
 }
 
-const std::vector<std::string>& ASCodeGenerator::run() {
-	for (const IRCommand& command : commands) {
+std::vector<std::string> ASCodeGenerator::run() {
+	for (const IRCommand& command : ir.commands) {
 		generate_command(command);
 	}
 	preamble();
@@ -98,7 +85,7 @@ const std::vector<std::string>& ASCodeGenerator::run() {
 			asm_out[i] = std::string{"\t"} + asm_out[i];
 		}
 	}
-	return asm_out;
+	return std::move(asm_out);
 }
 
 void ASCodeGenerator::preamble() {
@@ -155,6 +142,15 @@ void ASCodeGenerator::generate_command(const IRCommand& command) {
 		case IRCommandType::LEAVE:
 			leave(command);
 			return;
+		case IRCommandType::COMPARE:
+			compare(command);
+			return;
+		case IRCommandType::SET:
+			set(command);
+			return;
+		case IRCommandType::JUMP:
+			jump(command);
+			return;
 		default:
 			asm_out.push_back("Not supported just yet ;)");
 			return;
@@ -162,46 +158,28 @@ void ASCodeGenerator::generate_command(const IRCommand& command) {
 }
 
 void ASCodeGenerator::move(const IRCommand& command) {
-	// IR LHS & RHS
-	auto reg_lhs{std::dynamic_pointer_cast<ASMValRegister>(get_first(command).value())};
-	auto reg_rhs{std::dynamic_pointer_cast<ASMValRegister>(get_second(command).value())};
-	if (reg_lhs != nullptr && reg_rhs != nullptr) {
-		// If mem <- mem
-		if ((reg_lhs->reg->name == RegisterName::Base || reg_lhs->dereferenced) && (reg_rhs->reg->name == RegisterName::Base || reg_rhs->dereferenced)) {
-			auto reg{std::make_shared<ASMValRegister>(reg_rhs->held_type, occupy_next_reg())};
-			IRCommand temp_move{IRCommandType::MOVE, std::make_tuple(reg, reg_rhs, std::nullopt)};
-			IRCommand move_into{IRCommandType::MOVE, std::make_tuple(reg_lhs, reg, std::nullopt)};
-			move(temp_move);
-			move(move_into);
-			return;
-		}
+	auto [lhs, rhs, _]{command.args};
+	// If mem <- mem
+	if (lhs.is_memory() && rhs.is_memory()) {
+		Operand reg{Operand::reg(occupy_next_reg()->name, rhs.size())};
+		move(IRCommand{IRCommandType::MOVE, command.condition, command.is_signed, {reg, rhs}});
+		move(IRCommand{IRCommandType::MOVE, command.condition, command.is_signed, {lhs, reg}});
+		return;
 	}
 
-	auto get_side_sz = [&](const auto& side) {
-		uint8_t sz{side->held_type->get_size()};
-		if (auto reg{std::dynamic_pointer_cast<ASMValRegister>(side)}) {
-			if (!reg->offset.has_value())
-				sz = reg->reg_size;
-		}
-		return sz;
-	};
-	uint8_t lhs_size{get_side_sz(get_first(command).value())};
-	uint8_t rhs_size{get_side_sz(get_second(command).value())};
-
-	if (rhs_size < lhs_size) {
-		bool signed_lhs{get_first(command).value()->held_type->is_signed()};
-		std::string postfix{signed_lhs ? "s" : "z"};
-		postfix += get_cmd_postfix(rhs_size);
-		postfix += get_cmd_postfix(lhs_size);
+	if (rhs.size() < lhs.size()) {
+		std::string postfix{command.is_signed ? "s" : "z"};
+		postfix += get_cmd_postfix(rhs.size());
+		postfix += get_cmd_postfix(lhs.size());
 
 		asm_out.push_back(as_cmds[command.type] + postfix + " " +
-			asm_val_str(get_second(command).value()) + ", " +
-			asm_val_str(get_first(command).value())
+			asm_val_str(command, rhs) + ", " +
+			asm_val_str(command, lhs)
 		);
 	} else {
-		asm_out.push_back(as_cmds[command.type] + get_cmd_postfix(lhs_size) + " " +
-			asm_val_str(get_second(command).value()) + ", " +
-			asm_val_str(get_first(command).value())
+		asm_out.push_back(as_cmds[command.type] + get_cmd_postfix(lhs.size()) + " " +
+			asm_val_str(command, rhs) + ", " +
+			asm_val_str(command, lhs)
 		);
 	}
 }
@@ -218,8 +196,17 @@ void ASCodeGenerator::mul(const IRCommand& command) {
 	asm_out.push_back(basic_translation(command));
 }
 
+// Divides the accumulator by the second argument, after widening it into
+// the data register the way the command reads it.
 void ASCodeGenerator::div(const IRCommand& command) {
-	asm_out.push_back(basic_translation(command));
+	char postfix{get_cmd_postfix(command.args[0].size())};
+	if (command.is_signed) {
+		asm_out.push_back(postfix == 'q' ? "cqto" : "cltd");
+		asm_out.push_back(std::string{"idiv"} + postfix + " " + asm_val_str(command, command.args[1]));
+	} else {
+		asm_out.push_back("xorl %edx, %edx");
+		asm_out.push_back(as_cmds[command.type] + postfix + " " + asm_val_str(command, command.args[1]));
+	}
 }
 
 void ASCodeGenerator::xor_cmd(const IRCommand& command) {
@@ -231,7 +218,7 @@ void ASCodeGenerator::neg(const IRCommand& command) {
 }
 
 void ASCodeGenerator::call(const IRCommand& command) {
-	asm_out.push_back(as_cmds[command.type] + " " + std::dynamic_pointer_cast<ASMValNonRegister>(get_first(command).value())->value);
+	asm_out.push_back(as_cmds[command.type] + " " + text(command, command.args[0]));
 }
 
 void ASCodeGenerator::ret(const IRCommand& command) {
@@ -239,8 +226,8 @@ void ASCodeGenerator::ret(const IRCommand& command) {
 }
 
 void ASCodeGenerator::func(const IRCommand& command) {
-	asm_out.push_back(".global " + std::dynamic_pointer_cast<ASMValNonRegister>(get_first(command).value())->value);
-	asm_out.push_back(std::dynamic_pointer_cast<ASMValNonRegister>(get_first(command).value())->value + ":");
+	asm_out.push_back(".global " + text(command, command.args[0]));
+	asm_out.push_back(text(command, command.args[0]) + ":");
 }
 
 void ASCodeGenerator::push(const IRCommand& command) {
@@ -256,19 +243,32 @@ void ASCodeGenerator::lea(const IRCommand& command) {
 }
 
 void ASCodeGenerator::label(const IRCommand& command) {
-	asm_out.push_back(std::dynamic_pointer_cast<ASMValNonRegister>(get_first(command).value())->value + ":");
+	asm_out.push_back(text(command, command.args[0]) + ":");
 }
 
 void ASCodeGenerator::directive(const IRCommand& command) {
-	asm_out.push_back(
-		"." +
-		std::dynamic_pointer_cast<ASMValNonRegister>(get_first(command).value())->value +
-		" " +
-		std::dynamic_pointer_cast<ASMValNonRegister>(get_second(command).value())->value
-	);
+	std::string line{"." + text(command, command.args[0])};
+	if (command.args[1].has_value()) line += " " + text(command, command.args[1]);
+	asm_out.push_back(line);
 }
 
 void ASCodeGenerator::leave(const IRCommand& command) {
 	asm_out.push_back(as_cmds[command.type]);
 }
 
+
+void ASCodeGenerator::compare(const IRCommand& command) {
+	asm_out.push_back(basic_translation(command));
+}
+
+void ASCodeGenerator::set(const IRCommand& command) {
+	asm_out.push_back(as_cmds[command.type] + as_conditions[(size_t)command.condition] + " " +
+		asm_val_str(command, command.args[0])
+	);
+}
+
+void ASCodeGenerator::jump(const IRCommand& command) {
+	asm_out.push_back(as_cmds[command.type] + as_conditions[(size_t)command.condition] + " " +
+		text(command, command.args[0])
+	);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <map>
+#include <span>
 #include "IntermediateCodeGenerator.h"
 
 struct ASRegister {
@@ -36,7 +38,7 @@ static std::map<IRCommandType, std::string> as_cmds{
 	{IRCommandType::MOVE, "mov"},
 	{IRCommandType::ADD, "add"},
 	{IRCommandType::SUB, "sub"},
-	{IRCommandType::MULT, "mul"},
+	{IRCommandType::MULT, "imul"},
 	{IRCommandType::DIV, "div"},
 	{IRCommandType::XOR, "xor"},
 	{IRCommandType::NEG, "neg"},
@@ -45,28 +47,34 @@ static std::map<IRCommandType, std::string> as_cmds{
 	{IRCommandType::PUSH, "push"},
 	{IRCommandType::POP, "pop"},
 	{IRCommandType::LEA, "lea"},
-	{IRCommandType::LEAVE, "leave"}
+	{IRCommandType::LEAVE, "leave"},
+	{IRCommandType::COMPARE, "cmp"},
+	{IRCommandType::SET, "set"},
+	{IRCommandType::JUMP, "j"}
+};
+
+static const std::vector<std::string> as_conditions{
+	"mp", "e", "ne", "l", "le", "g", "ge", "b", "be", "a", "ae"
 };
 
 class ASCodeGenerator {
 public:
-	ASCodeGenerator(const std::vector<IRCommand>& commands)
-		: commands{commands} { }
+	explicit ASCodeGenerator(const IRModule& ir)
+		: ir{ir} { }
 
-	const std::vector<std::string>& run();
+	// Hands over the assembly; call once.
+	std::vector<std::string> run();
 
 private:
-	std::vector<IRCommand> commands{};
+	const IRModule& ir;
 	std::vector<std::string> asm_out{};
 
-	static const std::optional<ASMVal>& get_first(const IRCommand& cmd) noexcept { return std::get<0>(cmd.args); }
-	static const std::optional<ASMVal>& get_second(const IRCommand& cmd) noexcept { return std::get<1>(cmd.args); }
-	static const std::optional<ASMVal>& get_third(const IRCommand& cmd) noexcept { return std::get<2>(cmd.args); }
-
 	char get_cmd_postfix(uint8_t size);
 
-	std::string asm_cmd(const IRCommand& command, const std::optional<ASMVal>& arg1, const std::optional<ASMVal>& arg2 = std::nullopt, uint8_t cmd_size = 0u);
-	std::string asm_val_str(const ASMVal& val);
+	std::string asm_cmd(const IRCommand& command, uint8_t cmd_size = 0u);
+	std::string asm_val_str(const IRCommand& command, Operand val);
+	// A symbol or immediate as it is written outside an instruction operand.
+	std::string text(const IRCommand& command, Operand val);
 
 	std::string basic_translation(const IRCommand& command, uint8_t cmd_size = 0u);
 
@@ -88,4 +96,7 @@ private:
 	void label(const IRCommand& command);
 	void directive(const IRCommand& command);
 	void leave(const IRCommand& command);
+	void compare(const IRCommand& command);
+	void set(const IRCommand& command);
+	void jump(const IRCommand& command);
 };
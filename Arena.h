@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator that owns every AST node of one compilation. Nodes point
+// at each other with plain pointers and are never freed one by one: the
+// arena releases its blocks when it goes away. Nodes whose members still
+// own memory (types, parameter lists) get their destructor called from a
+// flat list first, so tearing down a deep tree never recurses.
+class Arena {
+public:
+	static constexpr size_t BLOCK_SIZE{64 * 1024};
+
+	Arena() = default;
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+	Arena(Arena&& other) noexcept { adopt(std::move(other)); }
+	Arena& operator=(Arena&&) = delete;
+	~Arena() { finalize(); }
+
+	template <typename T, typename... Args>
+	T* make(Args&&... args) {
+		T* node{new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...)};
+		if constexpr (!std::is_trivially_destructible_v<T>) {
+			finalizers.push_back({node, [](void* p) { ((T*)p)->~T(); }});
+		}
+		return node;
+	}
+
+	// Copies a finished child list into the arena.
+	template <std::ranges::contiguous_range R>
+	auto copy(const R& items) {
+		using T = std::remove_cv_t<std::ranges::range_value_t<R>>;
+		static_assert(std::is_trivially_copyable_v<T>);
+		if (std::ranges::empty(items)) return std::span<T>{};
+		T* out{(T*)allocate(sizeof(T) * std::ranges::size(items), alignof(T))};
+		std::ranges::uninitialized_copy(items, std::span{out, std::ranges::size(items)});
+		return std::span<T>{out, std::ranges::size(items)};
+	}
+
+	// Takes over everything `other` allocated, e.g. a ParallelParser chunk's nodes.
+	void adopt(Arena&& other) {
+		std::ranges::move(other.blocks, std::back_inserter(blocks));
+		std::ranges::move(other.finalizers, std::back_inserter(finalizers));
+		other.blocks.clear();
+		other.finalizers.clear();
+		// Keep filling whichever block has more room left.
+		if (other.end - other.cursor > end - cursor) {
+			cursor = other.cursor;
+			end = other.end;
+		}
+		other.cursor = other.end = nullptr;
+	}
+
+	size_t block_count() const noexcept { return blocks.size(); }
+
+	// Frees every node at once; the arena can be filled again afterwards.
+	void release() noexcept {
+		finalize();
+		blocks.clear();
+		cursor = end = nullptr;
+	}
+
+private:
+	struct Finalizer {
+		void* node;
+		void (*destroy)(void*);
+	};
+
+	std::vector<std::unique_ptr<std::byte[]>> blocks{};
+	std::vector<Finalizer> finalizers{};
+	std::byte* cursor{};
+	std::byte* end{};
+
+	void* allocate(size_t size, size_t align) {
+		std::byte* p{(std::byte*)(((uintptr_t)cursor + align - 1) & ~(uintptr_t)(align - 1))};
+		if (cursor == nullptr || p + size > end) {
+			size_t block_size{std::max(size + align, BLOCK_SIZE)};
+			blocks.push_back(std::make_unique_for_overwrite<std::byte[]>(block_size));
+			cursor = blocks.back().get();
+			end = cursor + block_size;
+			p = (std::byte*)(((uintptr_t)cursor + align - 1) & ~(uintptr_t)(align - 1));
+		}
+		cursor = p + size;
+		return p;
+	}
+
+	void finalize() noexcept {
+		for (const Finalizer& finalizer : finalizers) finalizer.destroy(finalizer.node);
+		finalizers.clear();
+	}
+};
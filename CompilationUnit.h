@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Arena.h"
+#include "Syntax.h"
+#include "IntermediateCodeGenerator.h"
+#include "SSA.h"
+
+// Everything one compilation produces, from the source text to the
+// assembly. Phases borrow the artifact they read and hand back theirs by
+// move, and the unit drops each one as soon as no later phase needs it, so
+// the tree is gone once it is in SSA, the SSA once it is lowered and the IR
+// before output.
+// Tokens are never kept: the Lexer feeds the Parser directly, and tokens
+// and types refer into `source`, which therefore lives as long as the unit.
+class CompilationUnit {
+public:
+	// Reads a source that outlives the unit, e.g. a mapped SourceFile.
+	explicit CompilationUnit(std::string_view source) : source{source} { }
+	// Takes the text over.
+	explicit CompilationUnit(std::string&& text) : text{std::move(text)}, source{this->text} { }
+
+	// `source` may view `text`, which would not survive a move.
+	CompilationUnit(const CompilationUnit&) = delete;
+	CompilationUnit& operator=(const CompilationUnit&) = delete;
+
+	void release_ast() noexcept {
+		statements = {};
+		arena.release();
+	}
+	void release_ssa() noexcept { ssa = {}; }
+	void release_ir() noexcept { ir = {}; }
+
+	// Empty unless the unit owns the source.
+	std::string text{};
+	const std::string_view source{};
+	Arena arena{};
+	std::vector<Statement*> statements{};
+	SSAModule ssa{};
+	IRModule ir{};
+	std::vector<std::string> assembly{};
+};
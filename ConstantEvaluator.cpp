@@ -0,0 +1,371 @@
+#include <cctype>
+#include <charconv>
+#include <utility>
+#include "ConstantEvaluator.h"
+#include "Environment.h"
+#include "Stack.h"
+
+std::optional<Constant> Constant::of(Type type, uint64_t bits) {
+	auto cons{type_cast<TConstructor>(type)};
+	if (cons == nullptr) return std::nullopt;
+	if (cons->type == types.at(TypeEnum::BOOL)) return Constant{type, bits != 0};
+	if (!is_number_type(cons->type)) return std::nullopt;
+
+	uint32_t width{cons->type.size * 8u};
+	if (width < 64) {
+		bits &= (1ull << width) - 1;
+		if (cons->type.is_signed && ((bits >> (width - 1)) & 1)) bits |= ~0ull << width;
+	}
+	return Constant{type, bits};
+}
+
+std::string Constant::text() const {
+	return (type->is_signed() ? std::to_string((int64_t)bits) : std::to_string(bits));
+}
+
+// Binds every identifier and call to what it names, with the scoping rules
+// of EnvironmentStack, and marks the variables that are ever written.
+struct ConstantEvaluator::Resolver {
+	ConstantEvaluator& evaluator;
+	ScopedTable<uint32_t> variables{};
+	ScopedTable<FunctionDeclarationStatement*> functions{};
+	std::vector<std::pair<size_t, size_t>> marks{};
+	uint32_t floor{};
+	const FunctionDeclarationStatement* function{};
+
+	uint32_t depth() const noexcept { return (uint32_t)marks.size(); }
+	bool visible(uint32_t scope) const noexcept { return (scope == 0 || scope >= floor); }
+
+	void push() { marks.emplace_back(variables.size(), functions.size()); }
+	void pop() {
+		variables.truncate(marks.back().first);
+		functions.truncate(marks.back().second);
+		marks.pop_back();
+	}
+
+	uint32_t declare(Symbol name, Type type, Expression* initializer) {
+		uint32_t id{(uint32_t)evaluator.variables.size()};
+		evaluator.variables.push_back({type, initializer, function});
+		variables.declare(name, depth(), id);
+		return id;
+	}
+
+	// The variable an assignment or `&` names, if it names one.
+	VariableInfo* target(Expression* expr) {
+		while (auto group{node_cast<GroupingExpression>(expr)}) expr = group->expr;
+		if (auto id{node_cast<IdentifierExpression>(expr)}) {
+			if (auto var{evaluator.variable_of.find(id)}; var != evaluator.variable_of.end()) {
+				return &evaluator.variables[var->second];
+			}
+		}
+		return nullptr;
+	}
+
+	void expression(Expression* expr);
+	void statement(Statement* stmt);
+};
+
+void ConstantEvaluator::Resolver::expression(Expression* expr) {
+	if (stack_exhausted()) return on_new_stack([&] { return expression(expr); });
+	auto in_view{[&](uint32_t scope) { return visible(scope); }};
+	visit(expr, overloaded{
+		[&](IdentifierExpression* id) {
+			if (auto var{variables.find(id->identifier.symbol, in_view)}) evaluator.variable_of.emplace(id, *var);
+		},
+		[&](LiteralExpression*) { },
+		[&](GroupingExpression* group) { expression(group->expr); },
+		[&](UnaryExpression* un) {
+			expression(un->expr);
+			// Pointing to a variable counts as writing it.
+			if (un->op.type != TokenType::AMPERSAND) return;
+			if (auto var{target(un->expr)}) var->written = var->addressed = true;
+		},
+		[&](BinaryExpression* bin) {
+			expression(bin->sides.first);
+			expression(bin->sides.second);
+			if (bin->op.type != TokenType::EQUAL) return;
+			if (auto var{target(bin->sides.first)}) var->written = true;
+		},
+		[&](BlockExpression* block) {
+			push();
+			for (Statement* stmt : block->statements) statement(stmt);
+			pop();
+		},
+		[&](CallExpression* call) {
+			if (auto callee{node_cast<IdentifierExpression>(call->callee)}) {
+				if (auto func{functions.find(callee->identifier.symbol, in_view)}) evaluator.callee_of.emplace(call, *func);
+			}
+			for (Expression* arg : call->args) expression(arg);
+		},
+		[&](ReturnExpression* ret) {
+			if (ret->return_expression != nullptr) expression(ret->return_expression);
+		},
+		[&](CastExpression* cast) { expression(cast->expr); },
+	});
+}
+
+void ConstantEvaluator::Resolver::statement(Statement* stmt) {
+	if (stack_exhausted()) return on_new_stack([&] { return statement(stmt); });
+	visit(stmt, overloaded{
+		[&](ExpressionStatement* expr) { expression(expr->expr); },
+		[&](VariableDeclarationStatement* decl) {
+			expression(decl->initializer);
+			evaluator.declared.emplace(decl, declare(decl->identifier->identifier.symbol, decl->type, decl->initializer));
+		},
+		[&](FunctionDeclarationStatement* func) {
+			// Calls only ever reach a generic's instances.
+			if (!func->type_params.empty()) return;
+			uint32_t outer_floor{std::exchange(floor, depth() + 1)};
+			const FunctionDeclarationStatement* outer_function{std::exchange(function, func)};
+			push();
+			evaluator.first_param.emplace(func, (uint32_t)evaluator.variables.size());
+			for (const auto& [type, name] : func->params) declare(name.symbol, type, nullptr);
+			for (Statement* body_stmt : func->block->statements) statement(body_stmt);
+			pop();
+			floor = outer_floor;
+			function = outer_function;
+			functions.declare(func->identifier->identifier.symbol, depth(), func);
+		},
+	});
+}
+
+ConstantEvaluator::ConstantEvaluator(std::span<Statement* const> stmts) {
+	Resolver resolver{*this};
+	for (Statement* stmt : stmts) {
+		resolver.statement(stmt);
+	}
+}
+
+FunctionDeclarationStatement* ConstantEvaluator::callee(const CallExpression* expr) const {
+	auto it{callee_of.find(expr)};
+	return (it != callee_of.end() ? it->second : nullptr);
+}
+
+std::optional<uint32_t> ConstantEvaluator::variable(const IdentifierExpression* expr) const {
+	auto it{variable_of.find(expr)};
+	if (it == variable_of.end()) return std::nullopt;
+	return it->second;
+}
+
+std::optional<Constant> ConstantEvaluator::fold(Expression* expr) {
+	if (auto it{folded.find(expr)}; it != folded.end()) return it->second;
+	std::optional<Constant> value{evaluate(expr)};
+	folded.emplace(expr, value);
+	return value;
+}
+
+std::optional<Constant> ConstantEvaluator::evaluate(Expression* expr) {
+	if (stack_exhausted()) return on_new_stack([&] { return evaluate(expr); });
+	if (frame != nullptr && ++steps > STEP_BUDGET) return std::nullopt;
+	return visit(expr, overloaded{
+		[&](IdentifierExpression* id) { return identifier(id); },
+		[&](LiteralExpression* lit) { return literal(lit); },
+		[&](GroupingExpression* group) { return value_of(group->expr); },
+		[&](UnaryExpression* un) { return unary(un); },
+		[&](BinaryExpression* bin) { return binary(bin); },
+		[&](BlockExpression* blk) { return block(blk); },
+		[&](CallExpression* c) { return call(c); },
+		[&](ReturnExpression*) -> std::optional<Constant> { return std::nullopt; },
+		[&](CastExpression* c) { return cast(c); },
+	});
+}
+
+std::optional<Constant> ConstantEvaluator::identifier(IdentifierExpression* expr) {
+	auto var{variable_of.find(expr)};
+	if (var == variable_of.end()) return std::nullopt;
+	if (frame != nullptr) {
+		if (auto local{frame->find(var->second)}; local != frame->end()) return local->second;
+	}
+
+	const VariableInfo& info{variables[var->second]};
+	if (info.written || info.initializer == nullptr) return std::nullopt;
+	Frame* running{std::exchange(frame, nullptr)};
+	std::optional<Constant> value{fold(info.initializer)};
+	frame = running;
+	if (!value) return std::nullopt;
+	return Constant::of(info.type, value->bits);
+}
+
+std::optional<Constant> ConstantEvaluator::literal(LiteralExpression* expr) {
+	switch (expr->value.type) {
+		case TokenType::TRUE:
+			return Constant::of(expr->type, 1);
+		case TokenType::FALSE:
+			return Constant::of(expr->type, 0);
+		case TokenType::CHAR_LITERAL:
+			return Constant::of(expr->type, (uint64_t)(int64_t)expr->value.text()[0]);
+		case TokenType::NUMBER_LITERAL: {
+			std::string_view text{expr->value.text()};
+			bool negative{text.starts_with('-')};
+			if (negative) text.remove_prefix(1);
+
+			uint64_t magnitude{};
+			auto [end, error]{std::from_chars(text.data(), text.data() + text.size(), magnitude)};
+			// Only a type suffix may follow the digits.
+			if (error != std::errc{} || (end != text.data() + text.size() && !std::isalpha(*end))) return std::nullopt;
+			return Constant::of(expr->type, negative ? 0 - magnitude : magnitude);
+		}
+		default:
+			return std::nullopt;
+	}
+}
+
+std::optional<Constant> ConstantEvaluator::unary(UnaryExpression* expr) {
+	auto value{value_of(expr->expr)};
+	if (!value) return std::nullopt;
+	switch (expr->op.type) {
+		case TokenType::NOT:
+			return Constant::of(expr->type, value->bits ^ 1);
+		case TokenType::MINUS:
+			return Constant::of(expr->type, 0 - value->bits);
+		default:
+			return std::nullopt;
+	}
+}
+
+std::optional<Constant> ConstantEvaluator::binary(BinaryExpression* expr) {
+	if (expr->op.type == TokenType::EQUAL) return assign(expr);
+
+	auto lhs{value_of(expr->sides.first)};
+	if (!lhs) return std::nullopt;
+	auto rhs{value_of(expr->sides.second)};
+	if (!rhs) return std::nullopt;
+
+	uint64_t l{lhs->bits};
+	uint64_t r{rhs->bits};
+	bool is_signed{lhs->type->is_signed()};
+	auto less{[&](uint64_t a, uint64_t b) { return (is_signed ? (int64_t)a < (int64_t)b : a < b); }};
+
+	switch (expr->op.type) {
+		case TokenType::PLUS:
+			return Constant::of(expr->type, l + r);
+		case TokenType::MINUS:
+			return Constant::of(expr->type, l - r);
+		case TokenType::STAR:
+			return Constant::of(expr->type, l * r);
+		case TokenType::SLASH: {
+			// Left for the program to trap on, like the division itself would.
+			if (r == 0) return std::nullopt;
+			if (!is_signed) return Constant::of(expr->type, l / r);
+			if ((int64_t)r == -1) {
+				// Only the type's minimum negates to itself, and that quotient overflows.
+				auto negated{Constant::of(expr->type, 0 - l)};
+				if (negated && l != 0 && negated->bits == l) return std::nullopt;
+				return negated;
+			}
+			return Constant::of(expr->type, (uint64_t)((int64_t)l / (int64_t)r));
+		}
+		case TokenType::EQUAL_EQUAL:
+			return Constant::of(expr->type, l == r);
+		case TokenType::NOT_EQUAL:
+			return Constant::of(expr->type, l != r);
+		case TokenType::LESS:
+			return Constant::of(expr->type, less(l, r));
+		case TokenType::LESS_EQUAL:
+			return Constant::of(expr->type, !less(r, l));
+		case TokenType::GREATER:
+			return Constant::of(expr->type, less(r, l));
+		case TokenType::GREATER_EQUAL:
+			return Constant::of(expr->type, !less(l, r));
+		case TokenType::AND:
+			return Constant::of(expr->type, l != 0 && r != 0);
+		case TokenType::OR:
+			return Constant::of(expr->type, l != 0 || r != 0);
+		default:
+			return std::nullopt;
+	}
+}
+
+std::optional<Constant> ConstantEvaluator::assign(BinaryExpression* expr) {
+	if (frame == nullptr) return std::nullopt;
+
+	Expression* target{expr->sides.first};
+	while (auto group{node_cast<GroupingExpression>(target)}) target = group->expr;
+	auto id{node_cast<IdentifierExpression>(target)};
+	auto var{id != nullptr ? variable_of.find(id) : variable_of.end()};
+	if (var == variable_of.end()) return std::nullopt;
+
+	auto value{evaluate(expr->sides.second)};
+	if (!value) return std::nullopt;
+	// Writing anything but the running call's own variables is an effect.
+	auto local{frame->find(var->second)};
+	if (local == frame->end()) return std::nullopt;
+	auto stored{Constant::of(variables[var->second].type, value->bits)};
+	if (stored) local->second = *stored;
+	return stored;
+}
+
+// Outside a call, a block's locals are only known through their
+// initializers, so a block that writes one is left to run.
+std::optional<Constant> ConstantEvaluator::block(BlockExpression* expr) {
+	std::optional<Constant> value{Constant{Type::of(TypeEnum::NONE)}};
+	for (Statement* stmt : expr->statements) {
+		if (!execute(stmt, value)) return std::nullopt;
+	}
+	return value;
+}
+
+bool ConstantEvaluator::execute(Statement* stmt, std::optional<Constant>& value) {
+	return visit(stmt, overloaded{
+		[&](ExpressionStatement* expr_stmt) {
+			// As in code generation, a block's value is that of its last return.
+			if (auto ret{node_cast<ReturnExpression>(expr_stmt->expr)}) {
+				value = (ret->return_expression != nullptr ? value_of(ret->return_expression) : Constant{Type::of(TypeEnum::NONE)});
+				return value.has_value();
+			}
+			return value_of(expr_stmt->expr).has_value();
+		},
+		[&](VariableDeclarationStatement* decl) {
+			auto init{value_of(decl->initializer)};
+			if (!init) return false;
+			if (frame == nullptr) return true;
+			auto stored{Constant::of(decl->type, init->bits)};
+			if (stored) (*frame)[declared.at(decl)] = *stored;
+			return stored.has_value();
+		},
+		// Outside a call, the block has a function to emit.
+		[&](FunctionDeclarationStatement*) { return frame != nullptr; },
+	});
+}
+
+std::optional<Constant> ConstantEvaluator::call(CallExpression* expr) {
+	auto callee{callee_of.find(expr)};
+	if (callee == callee_of.end()) return std::nullopt;
+	FunctionDeclarationStatement* func{callee->second};
+
+	Frame callee_frame{};
+	for (uint32_t i{0}; i < expr->args.size(); i++) {
+		auto arg{value_of(expr->args[i])};
+		if (!arg) return std::nullopt;
+		auto param{Constant::of(func->params[i].first, arg->bits)};
+		if (!param) return std::nullopt;
+		callee_frame.emplace(first_param.at(func) + i, *param);
+	}
+
+	// The budget covers a whole call made from outside, nested calls included.
+	if (frame == nullptr) steps = 0;
+	Frame* caller{std::exchange(frame, &callee_frame)};
+	std::optional<Constant> result{};
+	for (Statement* stmt : func->block->statements) {
+		// A return in the body itself ends the call; one in a nested block
+		// only gives that block its value.
+		if (auto expr_stmt{node_cast<ExpressionStatement>(stmt)}) {
+			if (auto ret{node_cast<ReturnExpression>(expr_stmt->expr)}) {
+				if (ret->return_expression != nullptr) result = evaluate(ret->return_expression);
+				break;
+			}
+		}
+		std::optional<Constant> ignored{};
+		if (!execute(stmt, ignored)) break;
+	}
+	frame = caller;
+
+	if (!result) return std::nullopt;
+	return Constant::of(expr->type, result->bits);
+}
+
+std::optional<Constant> ConstantEvaluator::cast(CastExpression* expr) {
+	auto value{value_of(expr->expr)};
+	if (!value) return std::nullopt;
+	return Constant::of(expr->type, value->bits);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Syntax.h"
+#include "Types.h"
+
+// A value known at compile time, held as the bits of its type: wrapped to
+// the type's width and sign-extended when the type is signed. A bool is 0
+// or 1. A none value stands for an expression with no value and no effect.
+struct Constant {
+	// Nothing for types without constant values, such as pointers.
+	static std::optional<Constant> of(Type type, uint64_t bits);
+
+	// Decimal, read as the type reads it.
+	std::string text() const;
+
+	Type type{};
+	uint64_t bits{};
+};
+
+// Evaluates expressions at compile time with the semantics of their types.
+// Besides literals, operators and casts, it follows variables that are
+// initialized to a constant and never written or pointed to, and calls
+// user functions by running their bodies. A body may only compute: a
+// native call, a pointer or a write to anything outside the call leaves
+// the call unknown, as does going over STEP_BUDGET.
+class ConstantEvaluator {
+public:
+	static constexpr uint32_t STEP_BUDGET{10000};
+
+	// Resolves the names in `stmts`, which must have passed analysis.
+	explicit ConstantEvaluator(std::span<Statement* const> stmts);
+
+	// The value of `expr`, if it is known without running the program.
+	// Remembered per node, so asking again on every subtree stays linear.
+	std::optional<Constant> fold(Expression* expr);
+
+	// The names it resolved, for passes that need the same bindings. Calls
+	// to natives and variables are not bound to a declaration.
+	FunctionDeclarationStatement* callee(const CallExpression* expr) const;
+	std::optional<uint32_t> variable(const IdentifierExpression* expr) const;
+	uint32_t variable(const VariableDeclarationStatement* decl) const { return declared.at(decl); }
+	uint32_t parameter(const FunctionDeclarationStatement* func, uint32_t index) const { return first_param.at(func) + index; }
+	// Whether the variable is ever assigned or pointed to.
+	bool is_written(uint32_t variable) const { return variables[variable].written; }
+	// Whether the variable is ever pointed to, so it must live in memory.
+	bool is_addressed(uint32_t variable) const { return variables[variable].addressed; }
+	// The function declaring the variable, null at the top level.
+	const FunctionDeclarationStatement* owner(uint32_t variable) const { return variables[variable].owner; }
+
+private:
+	struct Resolver;
+
+	struct VariableInfo {
+		Type type{};
+		// Null for parameters.
+		Expression* initializer{};
+		const FunctionDeclarationStatement* owner{};
+		bool written{};
+		bool addressed{};
+	};
+
+	// The values of a running call's parameters and locals.
+	using Frame = std::unordered_map<uint32_t, Constant>;
+
+	std::vector<VariableInfo> variables{};
+	std::unordered_map<const IdentifierExpression*, uint32_t> variable_of{};
+	std::unordered_map<const VariableDeclarationStatement*, uint32_t> declared{};
+	std::unordered_map<const FunctionDeclarationStatement*, uint32_t> first_param{};
+	std::unordered_map<const CallExpression*, FunctionDeclarationStatement*> callee_of{};
+
+	std::unordered_map<const Expression*, std::optional<Constant>> folded{};
+
+	// Null unless a call is being run; only values outside calls are remembered.
+	Frame* frame{};
+	uint32_t steps{};
+
+	std::optional<Constant> value_of(Expression* expr) { return frame == nullptr ? fold(expr) : evaluate(expr); }
+
+	std::optional<Constant> evaluate(Expression* expr);
+	std::optional<Constant> identifier(IdentifierExpression* expr);
+	std::optional<Constant> literal(LiteralExpression* expr);
+	std::optional<Constant> unary(UnaryExpression* expr);
+	std::optional<Constant> binary(BinaryExpression* expr);
+	std::optional<Constant> assign(BinaryExpression* expr);
+	std::optional<Constant> block(BlockExpression* expr);
+	std::optional<Constant> call(CallExpression* expr);
+	std::optional<Constant> cast(CastExpression* expr);
+
+	bool execute(Statement* stmt, std::optional<Constant>& value);
+};
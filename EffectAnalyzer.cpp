@@ -0,0 +1,166 @@
+#include "EffectAnalyzer.h"
+#include "Environment.h"
+#include "Stack.h"
+
+EffectAnalyzer::EffectAnalyzer(std::span<Statement* const> stmts, ConstantEvaluator& constants)
+	: constants{constants} {
+	for (Statement* stmt : stmts) {
+		summarize(stmt, nullptr);
+	}
+	for (uint32_t node{0}; node < nodes.size(); node++) {
+		if (!nodes[node].visited) connect(node);
+	}
+	solved = true;
+}
+
+Effect EffectAnalyzer::effect(const CallExpression* expr) const {
+	if (FunctionDeclarationStatement* callee{constants.callee(expr)}) return callee->effect;
+	auto id{node_cast<IdentifierExpression>(expr->callee)};
+	if (id == nullptr) return Effect::EFFECTFUL;
+	auto native{NATIVE_FUNCTIONS.find(id->identifier.symbol)};
+	return (native != NATIVE_FUNCTIONS.end() ? native->effect : Effect::EFFECTFUL);
+}
+
+// Summaries made for this have no function to call their writes local,
+// which is fine, as any write keeps the expression.
+bool EffectAnalyzer::removable(Expression* expr) {
+	Summary summary{summarize(expr, nullptr)};
+	return (summary.effect != Effect::EFFECTFUL && !summary.writes);
+}
+
+// Makes the function's node, with its own effect and its callees; a call
+// counts for nothing until the graph is solved.
+void EffectAnalyzer::collect(FunctionDeclarationStatement* func) {
+	auto [it, inserted]{node_of.try_emplace(func, (uint32_t)nodes.size())};
+	if (inserted) nodes.push_back({});
+	uint32_t node{it->second};
+	nodes[node].func = func;
+
+	Summary body{};
+	for (Statement* body_stmt : func->block->statements) {
+		join(body, summarize(body_stmt, func));
+	}
+	nodes[node].effect = body.effect;
+}
+
+// Tarjan's algorithm, which finishes each set of mutually recursive
+// functions after every function they call, so those effects are final.
+void EffectAnalyzer::connect(uint32_t node) {
+	if (stack_exhausted()) return on_new_stack([&] { return connect(node); });
+	nodes[node].index = nodes[node].low = next_index++;
+	nodes[node].visited = true;
+	nodes[node].on_stack = true;
+	tarjan_stack.push_back(node);
+
+	for (size_t i{0}; i < nodes[node].callees.size(); i++) {
+		uint32_t callee{nodes[node].callees[i]};
+		if (!nodes[callee].visited) {
+			connect(callee);
+			nodes[node].low = std::min(nodes[node].low, nodes[callee].low);
+		} else if (nodes[callee].on_stack) {
+			nodes[node].low = std::min(nodes[node].low, nodes[callee].index);
+		}
+	}
+	if (nodes[node].low != nodes[node].index) return;
+
+	auto first{std::ranges::find(tarjan_stack, node)};
+	std::vector<uint32_t> members{first, tarjan_stack.end()};
+	tarjan_stack.erase(first, tarjan_stack.end());
+
+	// Any callee still on the stack is in this set, so the set recurses.
+	Effect effect{Effect::PURE};
+	for (uint32_t member : members) {
+		effect = std::max(effect, nodes[member].effect);
+		for (uint32_t callee : nodes[member].callees) {
+			effect = std::max(effect, nodes[callee].on_stack ? Effect::EFFECTFUL : nodes[callee].effect);
+		}
+	}
+	for (uint32_t member : members) {
+		nodes[member].effect = effect;
+		nodes[member].func->effect = effect;
+		nodes[member].on_stack = false;
+	}
+}
+
+// `func` is the function the expression is evaluated in, whose own
+// variables are the only ones it may write without effect.
+EffectAnalyzer::Summary EffectAnalyzer::summarize(Expression* expr, const FunctionDeclarationStatement* func) {
+	if (stack_exhausted()) return on_new_stack([&] { return summarize(expr, func); });
+	if (solved) {
+		if (auto it{summaries.find(expr)}; it != summaries.end()) return it->second;
+	}
+
+	Summary summary{};
+	visit(expr, overloaded{
+		[&](IdentifierExpression* id) {
+			// A variable only something else writes may differ between calls.
+			auto var{constants.variable(id)};
+			if (var && constants.owner(*var) != func && constants.is_written(*var)) summary.effect = Effect::READ_ONLY;
+		},
+		[&](LiteralExpression*) { },
+		[&](GroupingExpression* group) { summary = summarize(group->expr, func); },
+		[&](UnaryExpression* un) {
+			summary = summarize(un->expr, func);
+			if (un->op.type == TokenType::STAR) join(summary, {Effect::READ_ONLY});
+		},
+		[&](BinaryExpression* bin) {
+			summary = summarize(bin->sides.first, func);
+			join(summary, summarize(bin->sides.second, func));
+			if (bin->op.type == TokenType::EQUAL) {
+				summary.writes = true;
+				Expression* target{bin->sides.first};
+				while (auto group{node_cast<GroupingExpression>(target)}) target = group->expr;
+				auto id{node_cast<IdentifierExpression>(target)};
+				auto var{id != nullptr ? constants.variable(id) : std::nullopt};
+				if (!var || constants.owner(*var) != func) summary.effect = Effect::EFFECTFUL;
+			} else if (bin->op.type == TokenType::SLASH) {
+				// Division by zero traps, as does dividing the 64-bit minimum by
+				// -1. Narrower types are divided in 64-bit registers.
+				auto divisor{constants.fold(bin->sides.second)};
+				bool overflows{divisor && divisor->type->is_signed() && divisor->type->get_size() == 8 && (int64_t)divisor->bits == -1};
+				if (!divisor || divisor->bits == 0 || overflows) summary.effect = Effect::EFFECTFUL;
+			}
+		},
+		[&](BlockExpression* block) {
+			for (Statement* stmt : block->statements) join(summary, summarize(stmt, func));
+		},
+		[&](CallExpression* call) { summary = this->call(call, func); },
+		[&](ReturnExpression* ret) {
+			if (ret->return_expression != nullptr) summary = summarize(ret->return_expression, func);
+			summary.writes = true;
+		},
+		[&](CastExpression* cast) { summary = summarize(cast->expr, func); },
+	});
+
+	if (solved) summaries.emplace(expr, summary);
+	return summary;
+}
+
+// Declaring a variable or a function writes nothing anyone else can see.
+EffectAnalyzer::Summary EffectAnalyzer::summarize(Statement* stmt, const FunctionDeclarationStatement* func) {
+	if (stack_exhausted()) return on_new_stack([&] { return summarize(stmt, func); });
+	return visit(stmt, overloaded{
+		[&](ExpressionStatement* expr) { return summarize(expr->expr, func); },
+		[&](VariableDeclarationStatement* decl) { return summarize(decl->initializer, func); },
+		[&](FunctionDeclarationStatement* decl) {
+			// Calls only ever reach a generic's instances.
+			if (!solved && decl->type_params.empty()) collect(decl);
+			return Summary{};
+		},
+	});
+}
+
+EffectAnalyzer::Summary EffectAnalyzer::call(CallExpression* expr, const FunctionDeclarationStatement* func) {
+	Summary summary{};
+	for (Expression* arg : expr->args) join(summary, summarize(arg, func));
+
+	FunctionDeclarationStatement* callee{constants.callee(expr)};
+	if (solved || callee == nullptr) {
+		join(summary, {effect(expr)});
+	} else if (func != nullptr) {
+		auto [it, inserted]{node_of.try_emplace(callee, (uint32_t)nodes.size())};
+		if (inserted) nodes.push_back({});
+		nodes[node_of.at(func)].callees.push_back(it->second);
+	}
+	return summary;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "ConstantEvaluator.h"
+#include "Syntax.h"
+
+// Finds the Effect of every function from its body and what it calls, and
+// keeps it on the declaration. A function is as effectful as the worst of
+// its own body and its callees; one that may call itself may never return,
+// so it is effectful. Natives are as their Function entry says.
+class EffectAnalyzer {
+public:
+	// `stmts` must have passed analysis; `constants` resolved their names.
+	EffectAnalyzer(std::span<Statement* const> stmts, ConstantEvaluator& constants);
+
+	// What evaluating the call may do, arguments aside.
+	Effect effect(const CallExpression* expr) const;
+	// Whether the value of `expr` is all it gives: it writes nothing, not
+	// even a local, returns nothing and always finishes, so it can be left
+	// out when unused.
+	bool removable(Expression* expr);
+
+private:
+	// What evaluating an expression may do. A write to a variable of the
+	// function being evaluated is no effect of the function, but it is one
+	// of the expression.
+	struct Summary {
+		Effect effect{Effect::PURE};
+		bool writes{};
+	};
+
+	// A function in the call graph, with Tarjan's numbering.
+	struct Node {
+		FunctionDeclarationStatement* func{};
+		std::vector<uint32_t> callees{};
+		Effect effect{Effect::PURE};
+		uint32_t index{};
+		uint32_t low{};
+		bool visited{};
+		bool on_stack{};
+	};
+
+	ConstantEvaluator& constants;
+
+	std::vector<Node> nodes{};
+	std::unordered_map<const FunctionDeclarationStatement*, uint32_t> node_of{};
+	std::vector<uint32_t> tarjan_stack{};
+	uint32_t next_index{};
+
+	// Only kept once every function's effect is known.
+	std::unordered_map<const Expression*, Summary> summaries{};
+	bool solved{};
+
+	static void join(Summary& into, const Summary& from) {
+		into.effect = std::max(into.effect, from.effect);
+		into.writes = into.writes || from.writes;
+	}
+
+	void collect(FunctionDeclarationStatement* func);
+	void connect(uint32_t node);
+	Summary summarize(Expression* expr, const FunctionDeclarationStatement* func);
+	Summary summarize(Statement* stmt, const FunctionDeclarationStatement* func);
+	Summary call(CallExpression* expr, const FunctionDeclarationStatement* func);
+};
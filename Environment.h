@@ -1,102 +1,184 @@
 #pragma once
 
+#include <cstdint>
+#include <deque>
+#include <optional>
 #include <set>
+#include <utility>
+#include <vector>
 #include "Syntax.h"
 #include "Types.h"
 
+// Variables and functions are ordered and found by symbol; the sets take
+// a bare Symbol as lookup key.
 struct Variable {
 	Type type{};
 	Token name{};
 
-	bool operator<(const Variable& var) const noexcept { return name < var.name; }
-	bool operator==(const Token& var) const noexcept { return name.value == var.value; }
+	bool operator<(const Variable& var) const noexcept { return name.symbol < var.name.symbol; }
+	friend bool operator<(const Variable& var, Symbol symbol) noexcept { return var.name.symbol < symbol; }
+	friend bool operator<(Symbol symbol, const Variable& var) noexcept { return symbol < var.name.symbol; }
+	bool operator==(const Token& var) const noexcept { return name.symbol == var.symbol; }
 };
 
 struct Function {
 	Type return_type{};
 	Token name{};
 	std::vector<Variable> args{};
-
-	bool operator<(const Function& func) const noexcept { return name < func.name; }
-	bool operator==(const Token& func) const noexcept { return (name.value == func.value); }
+	// The declaration, if the function is generic; its types name its type parameters.
+	FunctionDeclarationStatement* generic{};
+	// Natives say here what calling them does; a declared function's effect
+	// is found by EffectAnalyzer and kept on its declaration.
+	Effect effect{Effect::EFFECTFUL};
+
+	bool operator<(const Function& func) const noexcept { return name.symbol < func.name.symbol; }
+	friend bool operator<(const Function& func, Symbol symbol) noexcept { return func.name.symbol < symbol; }
+	friend bool operator<(Symbol symbol, const Function& func) noexcept { return symbol < func.name.symbol; }
+	bool operator==(const Token& func) const noexcept { return (name.symbol == func.symbol); }
 	bool operator==(const Function& func) const noexcept {
-		bool name_and_ret{name.value == func.name.value && comp_types(return_type, func.return_type)};
+		bool name_and_ret{name.symbol == func.name.symbol && return_type == func.return_type};
 	   	if (!name_and_ret) return false;
 		
 		if (args.size() != func.args.size()) return false;
 		for (int i{0}; i < args.size(); i++) {
-			if (!comp_types(args[i].type, func.args[i].type)) return false;
+			if (args[i].type != func.args[i].type) return false;
 		}
 
 		return true;
 	}
 
-	bool is_func(const Type& return_type, const std::string& name, const std::vector<Type>& args) const noexcept {
-		std::vector<Variable> var_args{
-			args
-			| std::views::transform([&](const Type& t) -> Variable { return Variable{t, Token{"", TokenType::IDENTIFIER, 0u}}; })
-			| std::ranges::to<std::vector>()
-		};
-		return *this == Function{return_type, Token{name}, var_args};
+	bool is_func(const Type& return_type, Symbol name, const std::vector<Type>& args) const noexcept {
+		if (this->name.symbol != name || this->return_type != return_type) return false;
+
+		if (this->args.size() != args.size()) return false;
+		for (int i{0}; i < args.size(); i++) {
+			if (this->args[i].type != args[i]) return false;
+		}
+
+		return true;
 	}
 };
 
-const std::set<Function> NATIVE_FUNCTIONS{
+const std::set<Function, std::less<>> NATIVE_FUNCTIONS{
 	Function{
-		std::make_shared<TConstructor>(types.at(TypeEnum::NONE)), {"write"},
+		Type::of(TypeEnum::NONE), {"write"},
 		{
-			Variable{std::make_shared<TConstructor>(types.at(TypeEnum::I32)), {"fd"}},
-			Variable{std::make_shared<TPointer>(std::make_shared<TConstructor>(types.at(TypeEnum::I8))), {"buf"}},
-			Variable{std::make_shared<TConstructor>(types.at(TypeEnum::I32)), {"count"}}
-		}
+			Variable{Type::of(TypeEnum::I32), {"fd"}},
+			Variable{Type::pointer_to(Type::of(TypeEnum::I8)), {"buf"}},
+			Variable{Type::of(TypeEnum::I32), {"count"}}
+		},
+		nullptr,
+		Effect::EFFECTFUL
 	}
 };
 
 
-struct Environment {
-	std::set<Variable> variables{};
-	std::set<Function> functions{};
-};
+// The innermost visible binding of each symbol in one namespace. Bindings
+// sit on a stack in declaration order and each remembers the one it
+// shadows, so dropping a scope restores the outer bindings in time
+// proportional to what the scope declared. Symbols are dense, so the head
+// of each chain is found by indexing rather than hashing.
+template <typename T>
+class ScopedTable {
+public:
+	static constexpr uint32_t NONE{UINT32_MAX};
+
+	// Skips bindings from scopes `visible` rejects.
+	template <typename Visible>
+	const T* find(Symbol symbol, Visible visible) const noexcept {
+		uint32_t i{symbol < heads.size() ? heads[symbol] : NONE};
+		while (i != NONE && !visible(bindings[i].scope)) i = bindings[i].shadowed;
+		return (i == NONE ? nullptr : &bindings[i].value);
+	}
+
+	// A second declaration in the same scope is ignored.
+	void declare(Symbol symbol, uint32_t scope, const T& value) {
+		if (symbol >= heads.size()) heads.resize(symbol + 1, NONE);
+		uint32_t head{heads[symbol]};
+		if (head != NONE && bindings[head].scope == scope) return;
+		heads[symbol] = (uint32_t)bindings.size();
+		bindings.push_back({value, symbol, scope, head});
+	}
 
-struct EnvironmentStack {
-	std::optional<Variable> get_variable(const Token& identifier) const noexcept {
-		for (auto env : envs) {
-			auto var{std::ranges::find_if(env.variables, [&](auto v){
-				return v == identifier;
-			})};
-			if (var != env.variables.end()) {
-				return *var;
-			}
+	size_t size() const noexcept { return bindings.size(); }
+
+	// Drops every binding made since size() was `mark`.
+	void truncate(size_t mark) {
+		while (bindings.size() > mark) {
+			heads[bindings.back().symbol] = bindings.back().shadowed;
+			bindings.pop_back();
 		}
+	}
 
-		return std::nullopt;
+private:
+	struct Binding {
+		T value{};
+		Symbol symbol{};
+		uint32_t scope{};
+		uint32_t shadowed{};
+	};
+
+	// A deque, so found bindings stay put while inner scopes declare more.
+	std::deque<Binding> bindings{};
+	std::vector<uint32_t> heads{};
+};
+
+// Variables and functions in scope. Scope 0 holds the native functions and
+// everything declared at top level; each block pushes another. A lookup
+// returns the innermost visible declaration, or nullptr, and stays valid
+// until that declaration's scope is popped.
+class EnvironmentStack {
+public:
+	EnvironmentStack() {
+		for (const Function& func : NATIVE_FUNCTIONS) declare(func);
 	}
-	std::optional<Function> get_function(const Token& identifier) const noexcept {
-		for (auto env : envs) {
-			auto func{std::ranges::find_if(env.functions, [&](auto f){
-				return f == identifier;
-			})};
-			if (func != env.functions.end()) {
-				return *func;
-			}
-		}
 
-		return std::nullopt;
+	const Variable* get_variable(const Token& identifier) const noexcept {
+		return variables.find(identifier.symbol, [&](uint32_t scope) { return visible(scope); });
+	}
+	const Function* get_function(const Token& identifier) const noexcept {
+		return functions.find(identifier.symbol, [&](uint32_t scope) { return visible(scope); });
 	}
 	bool has_identifier(const Token& identifier) const noexcept {
-		if (get_variable(identifier)) return true;
-		else return get_function(identifier).has_value();
+		return (get_variable(identifier) != nullptr || get_function(identifier) != nullptr);
 	}
 	std::optional<Type> get_identifier_type(const Token& identifier) const noexcept {
-		if (auto var{get_variable(identifier)}) return var.value().type;
-		else if (auto func{get_function(identifier)}) return func.value().return_type;
+		if (auto var{get_variable(identifier)}) return var->type;
+		else if (auto func{get_function(identifier)}) return func->return_type;
 		else return std::nullopt;
 	}
 
-	Environment& back() { return envs.back(); }
-	void push(const Environment& env) { envs.push_back(env); }
-	void pop() { envs.pop_back(); }
+	void declare(const Variable& var) { variables.declare(var.name.symbol, depth(), var); }
+	void declare(const Function& func) { functions.declare(func.name.symbol, depth(), func); }
 
-	std::vector<Environment> envs{Environment{{}, NATIVE_FUNCTIONS}};
-};
+	void push() { marks.push_back({variables.size(), functions.size()}); }
+	void pop() {
+		variables.truncate(marks.back().variables);
+		functions.truncate(marks.back().functions);
+		marks.pop_back();
+	}
 
+	// A function body sees the top level and its own scopes but not the
+	// locals around its declaration. Brackets the push() of the body; the
+	// returned floor goes back to leave_function(). Nothing is copied, so
+	// entering and leaving is constant time whatever is in scope.
+	uint32_t enter_function() noexcept { return std::exchange(floor, depth() + 1); }
+	void leave_function(uint32_t outer_floor) noexcept { floor = outer_floor; }
+
+private:
+	struct Mark {
+		size_t variables{};
+		size_t functions{};
+	};
+
+	ScopedTable<Variable> variables{};
+	ScopedTable<Function> functions{};
+	std::vector<Mark> marks{};
+	// Scopes 1 up to floor - 1 belong to enclosing functions and are hidden.
+	uint32_t floor{0};
+
+	uint32_t depth() const noexcept { return (uint32_t)marks.size(); }
+	bool visible(uint32_t scope) const noexcept {
+		return (scope == 0 || scope >= floor);
+	}
+};
@@ -4,22 +4,34 @@
 #include <iostream>
 #include "Lexer.h"
 
+// Set by worker threads whose diagnostics would interleave (see
+// ParallelParser); errors reported there are only counted.
+inline thread_local unsigned int* muted_errors{nullptr};
+
+static bool muted() noexcept {
+	if (muted_errors == nullptr) return false;
+	++*muted_errors;
+	return true;
+}
+
 static void report(unsigned int line, const std::string& where, const std::string& message) {
 	std::cerr << "Line " << std::to_string(line) << ' ' << where << ": " << message << std::endl;
 }
 
 static void error(unsigned int line, const std::string& message) noexcept {
+	if (muted()) return;
 	std::cout << "\033[1;31m";
 	report(line, "", message);
 	std::cout << "\033[0m";
 }
 
 static void error(const Token& token, const std::string& message) {
+	if (muted()) return;
 	std::cout << "\033[1;31m";
 	if (token.type == TokenType::END_OF_FILE) {
-		report(token.line, "at end", message);
+		report(token.line(), "at end", message);
 	} else {
-		report(token.line, "at '" + token.value + "'", message);
+		report(token.line(), "at '" + std::string{token.text()} + "'", message);
 	}
 	std::cout << "\033[0m";
 }
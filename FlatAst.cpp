@@ -0,0 +1,104 @@
+#include "FlatAst.h"
+#include "Stack.h"
+
+template <typename T>
+static uint32_t push(std::vector<T>& items, T item) {
+	items.push_back(std::move(item));
+	return (uint32_t)(items.size() - 1);
+}
+
+FlatAst FlatAst::flatten(std::span<Statement* const> stmts) {
+	FlatAst ast{};
+	for (Statement* stmt : stmts) {
+		ast.roots.push_back(ast.add(stmt));
+	}
+	return ast;
+}
+
+ChildRange FlatAst::reserve_children(size_t count) {
+	ChildRange range{(uint32_t)children.size(), (uint32_t)count};
+	children.resize(children.size() + count);
+	return range;
+}
+
+ExprId FlatAst::add(Expression* expr) {
+	if (expr == nullptr) return NO_NODE;
+	if (stack_exhausted()) return on_new_stack([&] { return add(expr); });
+
+	// Number the node before its children, then fill in its slot.
+	ExprId id{(ExprId)expression_kinds.size()};
+	expression_kinds.push_back(expr->kind);
+	expression_slots.push_back(0);
+	types.push_back(expr->type);
+	lvalues.push_back(expr->lvalue);
+
+	expression_slots[id] = ::visit(expr, overloaded{
+		[&](IdentifierExpression* ident) { return push(identifiers, {ident->identifier}); },
+		[&](LiteralExpression* lit) { return push(literals, {lit->value}); },
+		[&](GroupingExpression* group) {
+			ExprId inner{add(group->expr)};
+			return push(groupings, {inner});
+		},
+		[&](UnaryExpression* un) {
+			ExprId inner{add(un->expr)};
+			return push(unaries, {un->op, inner});
+		},
+		[&](BinaryExpression* bin) {
+			ExprId lhs{add(bin->sides.first)};
+			ExprId rhs{add(bin->sides.second)};
+			return push(binaries, {lhs, bin->op, rhs});
+		},
+		[&](BlockExpression* block) {
+			ChildRange statements{reserve_children(block->statements.size())};
+			for (uint32_t i{0}; i < statements.count; i++) {
+				StmtId child{add(block->statements[i])};
+				children[statements.first + i] = child;
+			}
+			return push(blocks, {statements, block->opening_block});
+		},
+		[&](CallExpression* call) {
+			ExprId callee{add(call->callee)};
+			ChildRange args{reserve_children(call->args.size())};
+			for (uint32_t i{0}; i < args.count; i++) {
+				ExprId arg{add(call->args[i])};
+				children[args.first + i] = arg;
+			}
+			return push(calls, {callee, call->closing_paren, args});
+		},
+		[&](ReturnExpression* ret) {
+			ExprId inner{add(ret->return_expression)};
+			return push(returns, {ret->return_tok, inner});
+		},
+		[&](CastExpression* cast) {
+			ExprId inner{add(cast->expr)};
+			return push(casts, {inner, cast->as, cast->cast_type});
+		},
+	});
+	return id;
+}
+
+StmtId FlatAst::add(Statement* stmt) {
+	if (stack_exhausted()) return on_new_stack([&] { return add(stmt); });
+
+	StmtId id{(StmtId)statement_kinds.size()};
+	statement_kinds.push_back(stmt->kind);
+	statement_slots.push_back(0);
+
+	statement_slots[id] = ::visit(stmt, overloaded{
+		[&](ExpressionStatement* expr) {
+			ExprId inner{add(expr->expr)};
+			return push(expression_statements, {inner});
+		},
+		[&](VariableDeclarationStatement* decl) {
+			ExprId identifier{add(decl->identifier)};
+			ExprId initializer{add(decl->initializer)};
+			return push(variable_declarations, {decl->type, identifier, initializer});
+		},
+		[&](FunctionDeclarationStatement* decl) {
+			ExprId identifier{add(decl->identifier)};
+			ExprId block{add(decl->block)};
+			return push(function_declarations, {decl->return_type, identifier, decl->params, block});
+		},
+	});
+	return id;
+}
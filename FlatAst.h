@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+#include "Syntax.h"
+
+// Index of an expression or statement in a FlatAst. The two are numbered
+// separately, parents before children, in source order.
+using ExprId = uint32_t;
+using StmtId = uint32_t;
+
+inline constexpr uint32_t NO_NODE{UINT32_MAX};
+
+// A child list: `count` ids starting at `first` in FlatAst::children.
+struct ChildRange {
+	uint32_t first{};
+	uint32_t count{};
+};
+
+// The same tree as the pointer-linked nodes in Syntax.h, laid out for
+// passes that stream over it. Each node kind lives in its own array and
+// nodes refer to each other by 32-bit ids; child lists are ranges into one
+// shared id array. Per expression, the kind, its slot in that kind's
+// array, its type and its lvalue flag sit in parallel arrays, so a pass
+// that only reads or rewrites types walks dense memory in id order.
+class FlatAst {
+public:
+	struct Unary {
+		Token op{};
+		ExprId expr{};
+	};
+	struct Binary {
+		ExprId lhs{};
+		Token op{};
+		ExprId rhs{};
+	};
+	struct Grouping {
+		ExprId expr{};
+	};
+	struct Literal {
+		Token value{};
+	};
+	struct Identifier {
+		Token identifier{};
+	};
+	struct Call {
+		ExprId callee{};
+		Token closing_paren{};
+		ChildRange args{};
+	};
+	struct Return {
+		Token return_tok{};
+		ExprId expr{};
+	};
+	struct Block {
+		ChildRange statements{};
+		Token opening_block{};
+	};
+	struct Cast {
+		ExprId expr{};
+		Token as{};
+		Type cast_type{};
+	};
+
+	struct ExpressionStmt {
+		ExprId expr{};
+	};
+	struct VariableDeclaration {
+		Type type{};
+		ExprId identifier{};
+		ExprId initializer{};
+	};
+	struct FunctionDeclaration {
+		Type return_type{};
+		ExprId identifier{};
+		std::span<const std::pair<Type, Token>> params{};
+		ExprId block{};
+	};
+
+	// Copies the tree under `stmts`, types and flags included. The params
+	// of function declarations still point into the original nodes.
+	static FlatAst flatten(std::span<Statement* const> stmts);
+
+	// Indexed by ExprId.
+	std::vector<ExpressionKind> expression_kinds{};
+	std::vector<uint32_t> expression_slots{};
+	std::vector<Type> types{};
+	std::vector<bool> lvalues{};
+
+	// Indexed by StmtId.
+	std::vector<StatementKind> statement_kinds{};
+	std::vector<uint32_t> statement_slots{};
+
+	std::vector<Unary> unaries{};
+	std::vector<Binary> binaries{};
+	std::vector<Grouping> groupings{};
+	std::vector<Literal> literals{};
+	std::vector<Identifier> identifiers{};
+	std::vector<Call> calls{};
+	std::vector<Return> returns{};
+	std::vector<Block> blocks{};
+	std::vector<Cast> casts{};
+
+	std::vector<ExpressionStmt> expression_statements{};
+	std::vector<VariableDeclaration> variable_declarations{};
+	std::vector<FunctionDeclaration> function_declarations{};
+
+	// Call arguments are ExprIds and block statements StmtIds.
+	std::vector<uint32_t> children{};
+	std::vector<StmtId> roots{};
+
+	std::span<const uint32_t> child_ids(ChildRange range) const {
+		return std::span{children}.subspan(range.first, range.count);
+	}
+
+	size_t expression_count() const noexcept { return expression_kinds.size(); }
+	size_t statement_count() const noexcept { return statement_kinds.size(); }
+
+	// Calls `f` with the payload of expression `id`, like visit() on nodes.
+	template <typename F>
+	decltype(auto) visit(ExprId id, F&& f) {
+		uint32_t slot{expression_slots[id]};
+		switch (expression_kinds[id]) {
+			case ExpressionKind::IDENTIFIER: return f(identifiers[slot]);
+			case ExpressionKind::LITERAL: return f(literals[slot]);
+			case ExpressionKind::GROUPING: return f(groupings[slot]);
+			case ExpressionKind::UNARY: return f(unaries[slot]);
+			case ExpressionKind::BINARY: return f(binaries[slot]);
+			case ExpressionKind::BLOCK: return f(blocks[slot]);
+			case ExpressionKind::CALL: return f(calls[slot]);
+			case ExpressionKind::RETURN: return f(returns[slot]);
+			case ExpressionKind::CAST: return f(casts[slot]);
+		}
+		std::unreachable();
+	}
+
+private:
+	ExprId add(Expression* expr);
+	StmtId add(Statement* stmt);
+	ChildRange reserve_children(size_t count);
+};
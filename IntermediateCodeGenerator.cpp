@@ -1,28 +1,6 @@
 #include <algorithm>
-#include <memory>
+#include <map>
 #include "IntermediateCodeGenerator.h"
-#include "Lexer.h"
-#include "Syntax.h"
-#include "Types.h"
-
-void IntermediateCodeGenerator::insert_command(const IRCommand& command) {
-	commands.insert(commands.begin()+commands_insert++, command);
-	for (size_t& jump : insert_jumps) {
-		if (jump > commands_insert-1) {
-	  		jump++;
-		}
-	}
-}
-
-void IntermediateCodeGenerator::push_insert_spot(size_t insert) {
-	insert_jumps.push_back(commands_insert);
-	commands_insert = insert;
-}
-
-void IntermediateCodeGenerator::pop_insert_spot() {
-	commands_insert = insert_jumps.back();
-	insert_jumps.pop_back();
-}
 
 inline Register* get_next_reg(bool occupy, bool include_important) {
 	for (Register& reg : registers) {
@@ -36,7 +14,7 @@ inline Register* get_next_reg(bool occupy, bool include_important) {
 	return nullptr;
 }
 
-inline Register* occupy_next_reg(bool include_important) {
+Register* occupy_next_reg(bool include_important) {
 	return get_next_reg(true, include_important);
 }
 
@@ -66,488 +44,582 @@ inline Register* get_reg(const RegisterName& name, bool occupy) {
 	return nullptr;
 }
 
-inline void unoccupy_if_reg(ASMVal& value) {
-	if (auto reg{std::dynamic_pointer_cast<ASMValRegister>(value)}) {
-		reg->reg->in_use = false;
-	}
+inline void unoccupy_if_reg(Operand value) {
+	if (value.kind() == OperandKind::REGISTER) get_reg(value.reg_name())->in_use = false;
 }
 
-int IntermediateCodeGenerator::create_var(const std::string& identifier, const Type& type, bool neg) {
-	int offset{};
-	if (neg) {
-		stacks.top().neg_size -= type->get_size();
-		stacks.top().neg_size = ceiling_multiple(stacks.top().neg_size, type->get_size());
-		offset = stacks.top().neg_size;
-	} else {
-		offset = stacks.top().pos_size;
-		stacks.top().pos_size += SZ_R;
+std::ostream& operator<<(std::ostream& os, const IRModule& ir) {
+	static std::vector<std::string> cmd_strs{
+		"MOVE", "ADD", "SUB", "MULT", "DIV", "XOR", "NEG", "CALL", "RET", "FUNC", "LABEL", "PUSH", "POP",
+		"LEA", "DIRECTIVE", "LEAVE", "COMPARE", "SET", "JUMP"
+	};
+	static std::vector<std::string> cond_strs{"", "E", "NE", "L", "LE", "G", "GE", "B", "BE", "A", "AE"};
+	static std::vector<std::string> reg_strs{
+		"RET", "CP1", "ARG4", "ARG3", "ARG2",
+		"ARG1", "ARG5", "ARG6", "GP1", "GP2",
+		"CP2", "CP3", "CP4", "CP5",
+		"STACK", "BASE", "INSTRUCTION"
+	};
+
+	for (const IRCommand& cmd : ir.commands) {
+		os << cmd_strs[(size_t)cmd.type];
+		if (cmd.condition != Condition::ALWAYS) os << '.' << cond_strs[(size_t)cmd.condition];
+		if (cmd.is_signed) os << " signed";
+		for (size_t i{0}; i < cmd.args.size() && cmd.args[i].has_value(); i++) {
+			Operand arg{cmd.args[i]};
+			os << (i == 0 ? " " : ", ");
+			switch (arg.kind()) {
+				case OperandKind::REGISTER: os << reg_strs[arg.id()] << ':' << (int)arg.size(); break;
+				case OperandKind::FRAME: os << "[BASE" << (arg.id() < 0 ? "" : "+") << arg.id() << "]:" << (int)arg.size(); break;
+				case OperandKind::INDIRECT: os << '[' << reg_strs[arg.id()] << "]:" << (int)arg.size(); break;
+				case OperandKind::IMMEDIATE: os << '#' << ir.immediates[arg.id()]; break;
+				default: os << '@' << ir.symbols[arg.id()]; break;
+			}
+		}
+		os << '\n';
 	}
+	return os;
+}
 
-	stacks.top().vars.push_back({identifier, type, offset});
-	return offset;
+IRModule IntermediateCodeGenerator::run() {
+	callee_symbols.resize(module.symbols.size());
+	string_symbols.resize(module.strings.size());
+	global_symbols.resize(module.globals.size());
+	for (size_t i{0}; i < module.functions.size(); i++) function(module.functions[i], i);
+	data();
+	return std::move(ir);
 }
 
-std::string IntermediateCodeGenerator::mangle_type(const std::string& t) {
-	if (t == "int") {
-		return "i";
-	} if (t == "str") {
-		return "s";
-	} if (t == "bool") {
-		return "b";
-	} if (t == "none") {
-		return "n";
-	} else {
-		return "";
-	}
+Operand IntermediateCodeGenerator::immediate(uint64_t value) {
+	auto [it, inserted]{immediate_ids.try_emplace(value, (int32_t)ir.immediates.size())};
+	if (inserted) ir.immediates.push_back(value);
+	return Operand::make(OperandKind::IMMEDIATE, SZ_R, it->second);
 }
 
-std::string IntermediateCodeGenerator::mangle_function(const std::shared_ptr<FunctionDeclarationStatement>& func) {
-	std::string name{"_Z"};
-	std::stack<std::string> env_stack_copy{env_stack};
-	
-	if (!env_stack_copy.empty()) {
-		name += "N";
-		do {
-			if (env_stack.top() == BLOCK_ENV_STACK_NAME) {
-				name += env_stack.top().substr(1);
-			} else {
-				name += std::to_string(env_stack_copy.top().size()) + env_stack_copy.top();
-			}
-			env_stack_copy.pop();
-		} while (!env_stack_copy.empty());
-		name += std::to_string(func->identifier->identifier.value.size()) + func->identifier->identifier.value;
-		name += "E";
-	} else {
-		name += std::to_string(func->identifier->identifier.value.size()) + func->identifier->identifier.value;
-	}
+Operand IntermediateCodeGenerator::symbol(std::string name) {
+	ir.symbols.push_back(std::move(name));
+	return Operand::make(OperandKind::SYMBOL, SZ_R, (int32_t)ir.symbols.size() - 1);
+}
 
-	/*if (func->params.empty()) {
-		name += mangle_type("none");
-	} else {
-		for (const std::pair<Token, Token>& param : func->params) {
-			name += mangle_type(param.first.value);
-		}
-	}*/
-	
-	return name;
+Operand IntermediateCodeGenerator::symbol(std::vector<Operand>& made, size_t index, const std::string& name) {
+	if (!made[index].has_value()) made[index] = symbol(name);
+	return made[index];
 }
 
-std::vector<IRCommand> IntermediateCodeGenerator::run() {
-	for (const auto& stmt : stmts) {
-		generate_statement(stmt);
-	}
-	return commands;
+// The registers values are kept in, besides the accumulator and GP1, which
+// commands work in: the argument registers in order, which a call loads in
+// that order, then one more a call overwrites, then those a function saves
+// before it uses them. Division overwrites the third.
+static constexpr std::array value_registers{
+	RegisterName::Arg1, RegisterName::Arg2, RegisterName::Arg3, RegisterName::Arg4, RegisterName::Arg5, RegisterName::Arg6,
+	RegisterName::GP2,
+	RegisterName::CP1, RegisterName::CP2, RegisterName::CP3, RegisterName::CP4, RegisterName::CP5,
+};
+constexpr size_t FIRST_UNLOADED{6};
+constexpr size_t FIRST_SAVED{7};
+constexpr size_t DIVIDEND_HIGH{2};
+
+// Only a move to a register takes an immediate wider than 32 bits.
+static bool fits_immediate(const Instruction& constant) {
+	return constant.type->get_size() < SZ_R || (int64_t)constant.imm == (int32_t)constant.imm;
 }
 
-ASMVal IntermediateCodeGenerator::generate_expression(const std::shared_ptr<Expression>& expr) {
-	if (auto id{std::dynamic_pointer_cast<IdentifierExpression>(expr)}) {
-		return identifier_expression(id);
-	} else if (auto lit{std::dynamic_pointer_cast<LiteralExpression>(expr)}) {
-		return literal_expression(lit);
-	} else if (auto group{std::dynamic_pointer_cast<GroupingExpression>(expr)}) {
-		return grouping_expression(group);
-	} else if (auto unary{std::dynamic_pointer_cast<UnaryExpression>(expr)}) {
-		return unary_expression(unary);
-	} else if (auto binary{std::dynamic_pointer_cast<BinaryExpression>(expr)}) {
-		return binary_expression(binary);
-	} else if (auto block{std::dynamic_pointer_cast<BlockExpression>(expr)}) {
-		return block_expression(block);
-	} else if (auto call{std::dynamic_pointer_cast<CallExpression>(expr)}) {
-		return call_expression(call);
-	} else if (auto ret{std::dynamic_pointer_cast<ReturnExpression>(expr)}) {
-		return return_expression(ret);
-	} else if (auto cast{std::dynamic_pointer_cast<CastExpression>(expr)}) {
-		return cast_expression(cast);
-	}
+// Where the caller left a parameter past the sixth: above the return
+// address and the caller's frame base.
+static Operand stack_parameter(uint32_t index, uint8_t size) {
+	return Operand::frame((int)(2 * SZ_R + SZ_R * (index - arg_regs.size())), size);
+}
 
-	return nullptr;
+// A register operand at another width; any other as it is.
+static Operand in_width(Operand operand, uint8_t size) {
+	return operand.kind() == OperandKind::REGISTER ? Operand::reg(operand.reg_name(), size) : operand;
 }
 
-ASMVal IntermediateCodeGenerator::identifier_expression(const std::shared_ptr<IdentifierExpression>& expr) {
-	if (auto it{std::ranges::find_if(stacks.top().vars, [&](auto v){return v.name==expr->identifier.value;})}; it != stacks.top().vars.end()) {
-		return std::make_shared<ASMValRegister>(it->type, it->pos);
-	} else {
-		return std::make_shared<ASMValNonRegister>(it->type, expr->identifier.value);
-	}
+// The register to work a result out in: its own, or the accumulator.
+static Operand work_register(Operand result, uint8_t size) {
+	return Operand::reg(result.kind() == OperandKind::REGISTER ? result.reg_name() : RegisterName::Ret, size);
 }
 
-ASMVal IntermediateCodeGenerator::literal_expression(const std::shared_ptr<LiteralExpression>& expr) {
-	if (expr->value.type == TokenType::TRUE) {
-		return std::make_shared<ASMValNonRegister>(expr->type, "1");
-	} else if (expr->value.type == TokenType::FALSE) {
-		return std::make_shared<ASMValNonRegister>(expr->type, "0");
-	} else if (expr->value.type == TokenType::CHAR_LITERAL) {
-		return std::make_shared<ASMValNonRegister>(expr->type, std::to_string((int)expr->value.value[0]));
-	} else if (expr->value.type == TokenType::STRING_LITERAL) {
-		push_insert_spot(0);
-		auto str{std::make_shared<ASMValNonRegister>(expr->type, ".STR" + std::to_string(str_count++))};
-		insert_command(IRCommand{IRCommandType::LABEL, std::make_tuple(
-			str, std::nullopt, std::nullopt
-		)});
-		insert_command(IRCommand{IRCommandType::DIRECTIVE, std::make_tuple(
-			std::make_shared<ASMValNonRegister>(nullptr, DIRECTIVES::ZSTR),
-			std::make_shared<ASMValNonRegister>(nullptr, "\"" + expr->value.value + "\""),
-			std::nullopt
-		)});
-		pop_insert_spot();
-		return str;
-	} else if (expr->value.type == TokenType::NUMBER_LITERAL) {
-		auto end{std::ranges::find_if(expr->value.value, [](char c) { return std::isalpha(c); })};
-		if (end != expr->value.value.end()) {
-			return std::make_shared<ASMValNonRegister>(expr->type, std::string{expr->value.value.begin(), end});
-		}
+// What a comparison tests with its operands the other way round.
+static Condition swapped(Condition condition) {
+	switch (condition) {
+		case Condition::L: return Condition::G;
+		case Condition::LE: return Condition::GE;
+		case Condition::G: return Condition::L;
+		case Condition::GE: return Condition::LE;
+		case Condition::B: return Condition::A;
+		case Condition::BE: return Condition::AE;
+		case Condition::A: return Condition::B;
+		case Condition::AE: return Condition::BE;
+		default: return condition;
 	}
-	
-	return std::make_shared<ASMValNonRegister>(expr->type, expr->value.value);
 }
 
-ASMVal IntermediateCodeGenerator::grouping_expression(const std::shared_ptr<GroupingExpression>& expr) {
-	return generate_expression(expr->expr);
+void IntermediateCodeGenerator::load(ValueId value, RegisterName name) {
+	load(location(value), func->values[value]->is_signed(), name);
 }
 
-ASMVal IntermediateCodeGenerator::unary_expression(const std::shared_ptr<UnaryExpression>& expr) {
-	auto rhs{generate_expression(expr->expr)};
-	auto reg{occupy_next_reg()};
-	if (expr->op.type == TokenType::NOT) {
-		insert_command(IRCommand{IRCommandType::XOR, std::make_tuple(
-			std::make_shared<ASMValRegister>(rhs->held_type, reg),
-			rhs,
-			std::make_shared<ASMValNonRegister>(rhs->held_type, "1")
-		)});
-	} else if (expr->op.type == TokenType::MINUS) {
-		insert_command(IRCommand{IRCommandType::NEG, std::make_tuple(
-			std::make_shared<ASMValRegister>(rhs->held_type, reg),
-			rhs,
-			std::nullopt
-		)});
-	} else if (expr->op.type == TokenType::AMPERSAND) {
-		auto ret{std::make_shared<ASMValRegister>(expr->type, reg)};
-		insert_command(IRCommand{IRCommandType::LEA, std::make_tuple(
-			ret, rhs, std::nullopt
-		)});
-
-		unoccupy_if_reg(rhs);
-		return ret;
-	} else if (expr->op.type == TokenType::STAR) {
-		ASMValRegister deref_reg{expr->type, reg, true};
-		deref_reg.dereferenced = false;
-		insert_command(IRCommand{IRCommandType::MOVE, std::make_tuple(
-			std::make_shared<ASMValRegister>(deref_reg), rhs, std::nullopt
-		)});
-		deref_reg.dereferenced = true;
-
-		unoccupy_if_reg(rhs);
-		return std::make_shared<ASMValRegister>(deref_reg);
-	}
+// Into the whole register, extended as the value's type reads it.
+void IntermediateCodeGenerator::load(Operand from, bool is_signed, RegisterName name) {
+	if (from == reg(name)) return;
+	// Writing the low half clears the rest.
+	bool low_half{from.kind() == OperandKind::IMMEDIATE ? ir.immediates[from.id()] <= UINT32_MAX : from.size() == SZ_E && !is_signed};
+	insert_command(IRCommand{IRCommandType::MOVE, Condition::ALWAYS, is_signed, {reg(name, low_half ? SZ_E : SZ_R), from}});
+}
 
-	unoccupy_if_reg(rhs);
-	return std::make_shared<ASMValRegister>(rhs->held_type, reg);
+// At the width of `to`, through the accumulator if both are memory.
+void IntermediateCodeGenerator::copy(Operand to, Operand from, bool is_signed) {
+	if (!to.has_value() || to == from) return;
+	if (to.is_memory() && from.is_memory()) {
+		Operand accumulator{reg(RegisterName::Ret, from.size())};
+		insert_command(IRCommand{IRCommandType::MOVE, Condition::ALWAYS, is_signed, {accumulator, from}});
+		from = accumulator;
+	}
+	insert_command(IRCommand{IRCommandType::MOVE, Condition::ALWAYS, is_signed, {to, from}});
 }
-ASMVal IntermediateCodeGenerator::binary_expression(const std::shared_ptr<BinaryExpression>& expr) {
-	ASMVal lhs{generate_expression(expr->sides.first)};
-	ASMVal rhs{generate_expression(expr->sides.second)};
-	switch (expr->op.type) {
-		case TokenType::PLUS:
-		case TokenType::MINUS:
-		case TokenType::STAR:
-		case TokenType::SLASH: {
-			// If literal (op) literal
-			if (auto lhs_non{std::dynamic_pointer_cast<ASMValNonRegister>(lhs)}) {
-				if (auto rhs_non{std::dynamic_pointer_cast<ASMValNonRegister>(rhs)}) {
-					auto execute_op{[&](auto x, auto y, TokenType op) {
-						if (expr->op.type == TokenType::PLUS) return x + y;
-						if (expr->op.type == TokenType::MINUS) return x - y;
-						if (expr->op.type == TokenType::STAR) return x * y;
-						if (expr->op.type == TokenType::SLASH) return x / y;
-						else return x;
-					}};
-					std::string asm_val{std::to_string(execute_op(
-						is_signed(lhs_non->held_type) ? (long long)std::stoll(lhs_non->value) : (unsigned long long)std::stoull(lhs_non->value),
-						is_signed(rhs_non->held_type) ? (long long)std::stoll(rhs_non->value) : (unsigned long long)std::stoull(rhs_non->value),
-						expr->op.type
-					))};
-					return std::make_shared<ASMValNonRegister>(lhs->held_type, asm_val);
-				}
-			}
 
-			IRCommandType type{};
-			if (expr->op.type == TokenType::PLUS) type = IRCommandType::ADD;
-			if (expr->op.type == TokenType::MINUS) type = IRCommandType::SUB;
-			if (expr->op.type == TokenType::STAR) type = IRCommandType::MULT;
-			if (expr->op.type == TokenType::SLASH) type = IRCommandType::DIV;
-
-			if (auto lhs_reg{std::dynamic_pointer_cast<ASMValRegister>(lhs)}) {
-				if (lhs_reg->offset.has_value()) {
-					auto reg{std::make_shared<ASMValRegister>(lhs->held_type, occupy_next_reg())};
-					insert_command(IRCommand{type, std::make_tuple(reg, lhs, rhs)});
-					unoccupy_if_reg(lhs);
-					unoccupy_if_reg(rhs);
-					return reg;
-				} else {
-					insert_command(IRCommand{type, std::make_tuple(lhs, lhs, rhs)});
-					unoccupy_if_reg(lhs);
-					unoccupy_if_reg(rhs);
-					return lhs;
-				}
-			}
+void IntermediateCodeGenerator::function(const SSAFunction& func, size_t index) {
+	this->func = &func;
+	std::vector<BlockId> order{func.reverse_postorder()};
+
+	int frame{allocate(order)};
+	slot_offset.clear();
+	for (size_t i{0}; i < func.slots.size(); i++) slot_offset.push_back(frame -= SZ_R);
+	frame = ceiling_multiple(-frame, 16);
+
+	block_labels.clear();
+	for (BlockId block{0}; block < func.blocks.size(); block++) {
+		block_labels.push_back(symbol(".L" + std::to_string(index) + "_" + std::to_string(block)));
+	}
+
+	insert_command(IRCommandType::FUNC, symbol(func.name));
+	insert_command(IRCommandType::PUSH, reg(RegisterName::Base));
+	insert_command(IRCommandType::MOVE, reg(RegisterName::Base), reg(RegisterName::Stack));
+	if (frame != 0) insert_command(IRCommandType::SUB, reg(RegisterName::Stack), reg(RegisterName::Stack), immediate(frame));
+	for (auto [name, offset] : saved_registers) insert_command(IRCommandType::MOVE, Operand::frame(offset, SZ_R), reg(name));
+
+	// Parameters in registers only move to registers none arrives in, which
+	// those on the stack may then take.
+	for (const Instruction& inst : func.blocks[0].instructions) {
+		if (inst.op == Opcode::PARAMETER && inst.imm < arg_regs.size()) {
+			copy(location(inst.result), reg(arg_regs[inst.imm], inst.type->get_size()));
+		}
+	}
+	for (const Instruction& inst : func.blocks[0].instructions) {
+		if (inst.op == Opcode::PARAMETER && inst.imm >= arg_regs.size()) {
+			copy(location(inst.result), stack_parameter((uint32_t)inst.imm, inst.type->get_size()));
 		}
-		case TokenType::EQUAL:
-			insert_command(IRCommand{IRCommandType::MOVE, std::make_tuple(lhs, rhs, std::nullopt)});
-			break;
-		default:
-			break;
 	}
 
-	unoccupy_if_reg(rhs);
-	return lhs;
+	for (size_t i{0}; i < order.size(); i++) {
+		BlockId block{order[i]};
+		if (block != 0) insert_command(IRCommandType::LABEL, block_labels[block]);
+		for (const Instruction& inst : func.blocks[block].instructions) {
+			instruction(inst, block, i + 1 < order.size() ? order[i + 1] : NO_ID);
+		}
+	}
 }
 
-ASMVal IntermediateCodeGenerator::block_expression(const std::shared_ptr<BlockExpression>& expr, const std::shared_ptr<FunctionDeclarationStatement>& func) {
-	if (func != nullptr) {
-		push_insert_spot(commands_insert);
-		stacks.push(Stack{0, 0, {}});
-			
-		std::vector<Register*> regs{};
-		for (const auto& param : func->params) {
-			Register* reg{occupy_next_arg_reg()};
-			if (reg != nullptr) {
-				int offset{create_var(param.second.value, param.first)};
-				insert_command(IRCommand{IRCommandType::MOVE, std::make_tuple(
-					std::make_shared<ASMValRegister>(param.first, offset),
-					std::make_shared<ASMValRegister>(param.first, reg),
-					std::nullopt
-				)});
-				regs.push_back(reg);
+// A linear scan over the function as it is laid out (Poletto and Sarkar).
+// With no loops, every block comes after its predecessors, so a value is
+// live at most from where it is defined to where it is last read. Each
+// instruction reads at an even position and defines at the odd one after,
+// so a result can take the register of an operand read for the last time.
+// A phi is written as each predecessor leaves, and is live from the first.
+// Returns how far below the frame base the registers saved and the values
+// left without one reach.
+int IntermediateCodeGenerator::allocate(const std::vector<BlockId>& order) {
+	size_t count{func->values.size()};
+	value_location.assign(count, Operand{});
+	std::vector<uint32_t> start(count, NO_ID);
+	std::vector<uint32_t> end(count, 0);
+	std::vector<uint32_t> parameter(count, NO_ID);
+	std::vector<uint32_t> leave(func->blocks.size(), NO_ID);
+	std::vector<uint32_t> calls{};
+	std::vector<const Instruction*> call_insts{};
+	std::vector<uint32_t> divisions{};
+
+	uint32_t position{1};
+	for (BlockId block : order) {
+		for (const Instruction& inst : func->blocks[block].instructions) {
+			uint32_t read{2 * position++};
+			if (inst.op != Opcode::PHI) {
+				for (ValueId operand : inst.operands) end[operand] = std::max(end[operand], read);
+			}
+			if (inst.op == Opcode::CALL) {
+				calls.push_back(read);
+				call_insts.push_back(&inst);
+			}
+			if (inst.op == Opcode::DIV) divisions.push_back(read);
+			if (inst.is_terminator()) leave[block] = read;
+			if (inst.result == NO_ID || inst.op == Opcode::PHI) continue;
+			if (inst.op == Opcode::CONSTANT && fits_immediate(inst)) {
+				value_location[inst.result] = immediate(inst.imm);
+			} else if (inst.op == Opcode::PARAMETER) {
+				// Parameters arrive before anything runs.
+				start[inst.result] = 1;
+				parameter[inst.result] = (uint32_t)inst.imm;
 			} else {
-				if (stacks.top().pos_size == 0) stacks.top().pos_size += 16;
-				create_var(param.second.value, param.first, false);
+				start[inst.result] = read + 1;
 			}
 		}
-		for (Register* reg : regs) reg->in_use = false;
 	}
-
-	env_stack.push(func == nullptr ? "_" + std::to_string(block_index++)
-				: func->identifier->identifier.value);
-
-	ASMVal ret_val{};
-	for (const std::shared_ptr<Statement>& stmt : expr->statements) {
-		if (auto expr_stmt{std::dynamic_pointer_cast<ExpressionStatement>(stmt)}) {
-			if (auto ret{std::dynamic_pointer_cast<ReturnExpression>(expr_stmt->expr)}) {
-	  			ret_val = return_expression(ret, func);
-	  		} else {
-				generate_expression(expr_stmt->expr);
+	for (BlockId block : order) {
+		const BasicBlock& target{func->blocks[block]};
+		for (const Instruction& inst : target.instructions) {
+			if (inst.op != Opcode::PHI) break;
+			for (size_t i{0}; i < target.predecessors.size(); i++) {
+				uint32_t at{leave[target.predecessors[i]]};
+				if (at == NO_ID) continue;
+				end[inst.operands[i]] = std::max(end[inst.operands[i]], at);
+				start[inst.result] = std::min(start[inst.result], at);
 			}
-		} else {
-			generate_statement(stmt);
-
 		}
 	}
 
-	if (func != nullptr) {
-		if (ret_val == nullptr) {
-			return_expression(std::make_shared<ReturnExpression>(Token{}, nullptr), func);
+	struct Interval {
+		ValueId value{};
+		uint32_t start{};
+		uint32_t end{};
+	};
+	std::vector<Interval> intervals{};
+	for (ValueId value{0}; value < count; value++) {
+		if (end[value] != 0 && start[value] != NO_ID && !value_location[value].has_value()) {
+			intervals.push_back({value, start[value], end[value]});
+		}
+	}
+	std::ranges::stable_sort(intervals, {}, &Interval::start);
+
+	std::array<ValueId, value_registers.size()> holder{};
+	holder.fill(NO_ID);
+	std::array<bool, value_registers.size()> used{};
+	std::vector<size_t> assigned(count, value_registers.size());
+	for (const Interval& interval : intervals) {
+		for (ValueId& held : holder) {
+			if (held != NO_ID && end[held] < interval.start) held = NO_ID;
 		}
 
-		pop_insert_spot();
-		int sub{-stacks.top().neg_size};
-		if (sub > 128 && !stacks.top().call_function) { // Red zone
-			sub = ceiling_multiple(sub - 128, 8);
-		} else if (stacks.top().call_function) {
-			sub = ceiling_multiple(sub, 16);
-		} else if (!stacks.top().vars.empty()) {
-			sub = std::max(16, sub);
+		// A value read after a call needs a register calls keep. One a call
+		// reads last can be in an argument register loaded after it is read.
+		size_t first{0};
+		auto call{std::ranges::lower_bound(calls, interval.start)};
+		if (call != calls.end() && *call < interval.end) {
+			first = FIRST_SAVED;
+		} else if (call != calls.end() && *call == interval.end) {
+			const std::vector<ValueId>& args{call_insts[call - calls.begin()]->operands};
+			for (size_t i{0}; i < args.size() && i < arg_regs.size(); i++) {
+				if (args[i] == interval.value) first = i;
+			}
 		}
-		if (sub != 0) {
-			static auto stack_reg = ASMValRegister{
-				create_sz(TypeEnum::U64), get_reg(RegisterName::Stack)
-			};
-			insert_command(IRCommand{IRCommandType::SUB, std::make_tuple(
-				std::make_shared<ASMValRegister>(stack_reg),
-				std::make_shared<ASMValRegister>(stack_reg),
-				std::make_shared<ASMValNonRegister>(
-					create_sz(TypeEnum::U64), std::to_string(sub)
-				)
-			)});
+		auto division{std::ranges::lower_bound(divisions, interval.start)};
+		bool across_division{division != divisions.end() && *division < interval.end};
+		auto fits{[&](size_t i) { return holder[i] == NO_ID && !(across_division && i == DIVIDEND_HIGH); }};
+
+		size_t chosen{holder.size()};
+		// A parameter stays in the register it arrives in, or moves to one
+		// no parameter arrives in.
+		if (uint32_t index{parameter[interval.value]}; index < arg_regs.size()) {
+			if (first <= index && fits(index)) chosen = index;
+			first = std::max(first, FIRST_UNLOADED);
 		}
-
-		stacks.pop();
+		for (size_t i{first}; chosen == holder.size() && i < holder.size(); i++) {
+			if (fits(i)) chosen = i;
+		}
+		if (chosen == holder.size()) {
+			// Out of registers: whichever value is read last goes to memory.
+			size_t victim{FIRST_SAVED};
+			for (size_t i{first}; i < holder.size(); i++) {
+				if ((across_division && i == DIVIDEND_HIGH) || holder[i] == NO_ID) continue;
+				if (end[holder[i]] > end[holder[victim]]) victim = i;
+			}
+			if (end[holder[victim]] <= interval.end) continue;
+			assigned[holder[victim]] = holder.size();
+			chosen = victim;
+		}
+		holder[chosen] = interval.value;
+		assigned[interval.value] = chosen;
+		used[chosen] = true;
 	}
 
-	env_stack.pop();
-
-	return ret_val;
-}
-
-ASMVal IntermediateCodeGenerator::call_expression(const std::shared_ptr<CallExpression>& expr) {
-	stacks.top().call_function = true;
-
-	std::vector<Register*> regs{};
-	int pushed_size{};
-	int push_count{};
-	int first_push_i{-1};
-	std::vector<ASMVal> arg_vals{};
-	arg_vals.reserve(expr->args.size());
-	for (int i{0}; i < expr->args.size(); i++) {
-		ASMVal arg_val{generate_expression(expr->args[i])};
-		arg_vals.push_back(arg_val);
-
-		Register* reg{occupy_next_arg_reg()};
-		if (reg != nullptr) {
-			Type mv_type{expr->args[i]->type};
-			if (mv_type->get_size() < SZ_E) mv_type = create_sz(TypeEnum::U32);
-			insert_command(IRCommand{IRCommandType::MOVE, std::make_tuple(
-				std::make_shared<ASMValRegister>(expr->args[i]->type, reg),
-				arg_val,
-				std::nullopt
-			)});
-			regs.push_back(reg);
+	int frame{};
+	saved_registers.clear();
+	for (size_t i{FIRST_SAVED}; i < value_registers.size(); i++) {
+		if (used[i]) saved_registers.emplace_back(value_registers[i], frame -= SZ_R);
+	}
+	for (const Interval& interval : intervals) {
+		ValueId value{interval.value};
+		uint8_t size{func->values[value]->get_size()};
+		if (assigned[value] < value_registers.size()) {
+			value_location[value] = reg(value_registers[assigned[value]], size);
+		} else if (parameter[value] != NO_ID && parameter[value] >= arg_regs.size()) {
+			value_location[value] = stack_parameter(parameter[value], size);
 		} else {
-			if (first_push_i == -1) first_push_i = i;
-			push_count++;
+			value_location[value] = Operand::frame(frame -= SZ_R, size);
 		}
 	}
-	for (size_t i{expr->args.size()-1}; i >= first_push_i; i--) {
-		if (auto reg{std::dynamic_pointer_cast<ASMValRegister>(arg_vals[i])}) {
-			reg->reg_size = SZ_R;
-		} else {
-			std::dynamic_pointer_cast<ASMValNonRegister>(arg_vals[i])->held_type = create_sz(TypeEnum::U64);
+	return frame;
+}
+
+// `next` is the block laid out after this one, which needs no jump.
+void IntermediateCodeGenerator::instruction(const Instruction& inst, BlockId block, BlockId next) {
+	switch (inst.op) {
+		case Opcode::CONSTANT: {
+			// Those that fit are written where they are read.
+			Operand result{location(inst.result)};
+			if (!result.has_value() || result.kind() == OperandKind::IMMEDIATE) return;
+			Operand work{work_register(result, SZ_R)};
+			insert_command(IRCommand{IRCommandType::MOVE, Condition::ALWAYS, inst.type->is_signed(), {work, immediate(inst.imm)}});
+			copy(result, work);
+			return;
+		}
+		case Opcode::PARAMETER:
+		case Opcode::PHI:
+			// Moved into place on entry, and by the predecessors.
+			return;
+		case Opcode::STRING:
+			address(inst, symbol(string_symbols, inst.imm, ".STR" + std::to_string(inst.imm)));
+			return;
+		case Opcode::GLOBAL:
+			address(inst, symbol(global_symbols, inst.imm, module.globals[inst.imm].name));
+			return;
+		case Opcode::SLOT:
+			address(inst, Operand::frame(slot_offset[inst.imm], func->slots[inst.imm]->get_size()));
+			return;
+		case Opcode::LOAD:
+		case Opcode::STORE: {
+			Operand pointer{location(inst.operands[0])};
+			if (pointer.kind() != OperandKind::REGISTER) {
+				copy(reg(RegisterName::GP1), pointer);
+				pointer = reg(RegisterName::GP1);
+			}
+			if (inst.op == Opcode::LOAD) {
+				copy(location(inst.result), Operand::indirect(pointer.reg_name(), inst.type->get_size()));
+			} else {
+				Type type{func->values[inst.operands[1]]};
+				copy(Operand::indirect(pointer.reg_name(), type->get_size()), location(inst.operands[1]), type->is_signed());
+			}
+			return;
+		}
+		case Opcode::ADD:
+		case Opcode::SUB:
+		case Opcode::MUL:
+			arithmetic(inst);
+			return;
+		case Opcode::DIV:
+			divide(inst);
+			return;
+		case Opcode::NEG:
+		case Opcode::NOT:
+			unary(inst);
+			return;
+		case Opcode::EQUAL:
+		case Opcode::NOT_EQUAL:
+		case Opcode::LESS:
+		case Opcode::LESS_EQUAL:
+		case Opcode::GREATER:
+		case Opcode::GREATER_EQUAL:
+			compare(inst);
+			return;
+		case Opcode::CAST:
+			cast(inst);
+			return;
+		case Opcode::CALL:
+			call(inst);
+			return;
+		case Opcode::JUMP:
+			leave_block(block);
+			if (inst.targets[0] != next) insert_command(IRCommandType::JUMP, block_labels[inst.targets[0]]);
+			return;
+		case Opcode::BRANCH: {
+			leave_block(block);
+			auto [if_true, if_false]{inst.targets};
+			Operand condition{location(inst.operands[0])};
+			if (condition.kind() == OperandKind::IMMEDIATE) {
+				BlockId target{ir.immediates[condition.id()] != 0 ? if_true : if_false};
+				if (target != next) insert_command(IRCommandType::JUMP, block_labels[target]);
+				return;
+			}
+			insert_command(IRCommandType::COMPARE, condition, immediate(0));
+			if (if_true == next) {
+				insert_command(IRCommand{IRCommandType::JUMP, Condition::E, false, {block_labels[if_false]}});
+				return;
+			}
+			insert_command(IRCommand{IRCommandType::JUMP, Condition::NE, false, {block_labels[if_true]}});
+			if (if_false != next) insert_command(IRCommandType::JUMP, block_labels[if_false]);
+			return;
 		}
-		insert_command(IRCommand{IRCommandType::PUSH, std::make_tuple(arg_vals[i], std::nullopt, std::nullopt)});
-		pushed_size += arg_vals[i]->held_type->get_size();
+		case Opcode::RETURN:
+			if (!inst.operands.empty()) load(inst.operands[0], RegisterName::Ret);
+			for (auto [name, offset] : saved_registers) insert_command(IRCommandType::MOVE, reg(name), Operand::frame(offset, SZ_R));
+			insert_command(IRCommandType::LEAVE);
+			insert_command(IRCommandType::RET);
+			return;
 	}
-	for (Register* reg : regs) reg->in_use = false;
+}
 
-	std::string name{std::dynamic_pointer_cast<IdentifierExpression>(expr->callee)->identifier.value};
-	std::vector<Type> args{
-		expr->args
-			| std::views::transform([](auto arg){return arg->type;})
-			| std::ranges::to<std::vector>()
-	};
+void IntermediateCodeGenerator::address(const Instruction& inst, Operand target) {
+	Operand result{location(inst.result)};
+	Operand work{work_register(result, SZ_R)};
+	insert_command(IRCommandType::LEA, work, target);
+	copy(result, work);
+}
 
-	bool is_native_func{
-		std::ranges::find_if(NATIVE_FUNCTIONS, [&](const Function& native_func){
-			return native_func.is_func(expr->type, name, args);
-		}) != NATIVE_FUNCTIONS.end()
-	};
-	if (!is_native_func) {
-		name = {funcs[name]};
+void IntermediateCodeGenerator::unary(const Instruction& inst) {
+	Operand result{location(inst.result)};
+	Operand work{work_register(result, inst.type->get_size())};
+	copy(work, location(inst.operands[0]), inst.type->is_signed());
+	if (inst.op == Opcode::NEG) {
+		insert_command(IRCommandType::NEG, work);
+	} else {
+		insert_command(IRCommandType::XOR, work, work, immediate(1));
 	}
+	copy(result, work);
+}
 
-	insert_command(IRCommand{IRCommandType::CALL, std::make_tuple(
-		std::make_shared<ASMValNonRegister>(expr->type, name),
-		std::nullopt,
-		std::nullopt
-	)});
-	
-	if (pushed_size > 0) {
-		static auto stack_reg{ASMValRegister{create_sz(TypeEnum::U64), get_reg(RegisterName::Stack)}};
-		insert_command(IRCommand{IRCommandType::ADD, std::make_tuple(
-			std::make_shared<ASMValRegister>(stack_reg),
-			std::make_shared<ASMValRegister>(stack_reg),
-			std::make_shared<ASMValNonRegister>(create_sz(TypeEnum::U64), std::to_string(pushed_size))
-		)});
+// At the result's width, except that bytes are multiplied in 32 bits, as
+// there is no two-operand byte multiply; the low byte is the same.
+void IntermediateCodeGenerator::arithmetic(const Instruction& inst) {
+	bool is_signed{inst.type->is_signed()};
+	uint8_t size{inst.op == Opcode::MUL && inst.type->get_size() == SZ_H ? SZ_E : inst.type->get_size()};
+	IRCommandType command{inst.op == Opcode::ADD ? IRCommandType::ADD : inst.op == Opcode::SUB ? IRCommandType::SUB : IRCommandType::MULT};
+
+	Operand result{location(inst.result)};
+	Operand lhs{location(inst.operands[0])};
+	Operand rhs{location(inst.operands[1])};
+	auto in_result{[&](Operand operand) {
+		return operand.kind() == OperandKind::REGISTER && result.kind() == OperandKind::REGISTER && operand.reg_name() == result.reg_name();
+	}};
+	// The result may have the right operand's register, which is read after
+	// the left is moved into it.
+	if (command != IRCommandType::SUB && (lhs.kind() == OperandKind::IMMEDIATE || in_result(rhs))) std::swap(lhs, rhs);
+	if (rhs.is_memory() && rhs.size() < size) {
+		copy(reg(RegisterName::GP1, size), rhs, is_signed);
+		rhs = reg(RegisterName::GP1, size);
 	}
+	Operand work{in_result(rhs) ? reg(RegisterName::Ret, size) : work_register(result, size)};
+	copy(work, in_width(lhs, size), is_signed);
+	insert_command(IRCommand{command, Condition::ALWAYS, is_signed, {work, work, in_width(rhs, size)}});
+	copy(result, in_width(work, inst.type->get_size()));
+}
 
-	return std::make_shared<ASMValRegister>(expr->type, occupy_reg(RegisterName::Ret));
+// In whole registers, so that no narrower division overflows.
+void IntermediateCodeGenerator::divide(const Instruction& inst) {
+	load(inst.operands[0], RegisterName::Ret);
+	load(inst.operands[1], RegisterName::GP1);
+	insert_command(IRCommand{IRCommandType::DIV, Condition::ALWAYS, inst.type->is_signed(), {reg(RegisterName::Ret), reg(RegisterName::GP1)}});
+	copy(location(inst.result), reg(RegisterName::Ret, inst.type->get_size()));
 }
 
-ASMVal IntermediateCodeGenerator::return_expression(const std::shared_ptr<ReturnExpression>& expr, const std::shared_ptr<FunctionDeclarationStatement>& func) {
-	if (expr->return_expression != nullptr) {
-		Type mv_type{expr->type};
-		if (mv_type->get_size() < SZ_E) mv_type = create_sz(TypeEnum::U32);
-		insert_command(IRCommand{IRCommandType::MOVE, std::make_tuple(
-			std::make_shared<ASMValRegister>(mv_type, occupy_reg(RegisterName::Ret)),
-			generate_expression(expr->return_expression),
-			std::nullopt
-		)});
+void IntermediateCodeGenerator::compare(const Instruction& inst) {
+	Operand result{location(inst.result)};
+	if (!result.has_value()) return;
+	Type type{func->values[inst.operands[0]]};
+	bool is_signed{type->is_signed()};
+	Condition condition{};
+	switch (inst.op) {
+		case Opcode::EQUAL: condition = Condition::E; break;
+		case Opcode::NOT_EQUAL: condition = Condition::NE; break;
+		case Opcode::LESS: condition = is_signed ? Condition::L : Condition::B; break;
+		case Opcode::LESS_EQUAL: condition = is_signed ? Condition::LE : Condition::BE; break;
+		case Opcode::GREATER: condition = is_signed ? Condition::G : Condition::A; break;
+		default: condition = is_signed ? Condition::GE : Condition::AE; break;
 	}
 
-	if (func != nullptr) {
-		if (stacks.top().vars.empty()) {
-			insert_command(IRCommand{IRCommandType::POP, std::make_tuple(
-				std::make_shared<ASMValRegister>(create_sz(TypeEnum::U64), occupy_reg(RegisterName::Base), false),
-				std::nullopt,
-				std::nullopt
-			)});
-		} else {
-			insert_command(IRCommand{IRCommandType::LEAVE,
-				std::make_tuple(std::nullopt, std::nullopt, std::nullopt)
-			});
-		}
-		insert_command(IRCommand{IRCommandType::RET, std::make_tuple(std::nullopt, std::nullopt, std::nullopt)});
+	Operand lhs{location(inst.operands[0])};
+	Operand rhs{location(inst.operands[1])};
+	if (lhs.kind() == OperandKind::IMMEDIATE && rhs.kind() != OperandKind::IMMEDIATE) {
+		std::swap(lhs, rhs);
+		condition = swapped(condition);
 	}
-
-	if (expr->return_expression != nullptr)
-		return std::make_shared<ASMValRegister>(expr->type, occupy_reg(RegisterName::Ret));
-	else
-		return nullptr;
+	// Only the right can be an immediate, and only one can be memory.
+	if (lhs.kind() == OperandKind::IMMEDIATE || (lhs.is_memory() && rhs.is_memory())) {
+		Operand accumulator{reg(RegisterName::Ret, type->get_size())};
+		copy(accumulator, lhs, is_signed);
+		lhs = accumulator;
+	}
+	insert_command(IRCommand{IRCommandType::COMPARE, Condition::ALWAYS, is_signed, {lhs, rhs}});
+	insert_command(IRCommand{IRCommandType::SET, condition, false, {result}});
 }
 
-ASMVal IntermediateCodeGenerator::cast_expression(const std::shared_ptr<CastExpression>& expr) {
-	auto ret{generate_expression(expr->expr)};
-	ret->held_type = expr->type;
-	return ret;
-}
+void IntermediateCodeGenerator::cast(const Instruction& inst) {
+	Operand result{location(inst.result)};
+	if (!result.has_value()) return;
+	Type from{func->values[inst.operands[0]]};
+	uint8_t from_size{from->get_size()};
+	uint8_t to_size{inst.type->get_size()};
+
+	Operand value{location(inst.operands[0])};
+	if (value.kind() == OperandKind::IMMEDIATE) {
+		// Constants are kept extended to 64 bits, as their type reads them.
+		insert_command(IRCommand{IRCommandType::MOVE, Condition::ALWAYS, from->is_signed(), {reg(RegisterName::Ret), value}});
+		value = reg(RegisterName::Ret, from_size);
+	}
 
-void IntermediateCodeGenerator::generate_statement(const std::shared_ptr<Statement>& stmt) {
-	if (auto decl{std::dynamic_pointer_cast<VariableDeclarationStatement>(stmt)}) {
-		variable_declaration_statement(decl);
-	} else if (auto decl{std::dynamic_pointer_cast<FunctionDeclarationStatement>(stmt)}) {
-		function_declaration_statement(decl);
-	} else if (auto expr{std::dynamic_pointer_cast<ExpressionStatement>(stmt)}) {
-		expression_statement(expr);
+	if (inst.type == Type::of(TypeEnum::BOOL)) {
+		insert_command(IRCommandType::COMPARE, value, immediate(0));
+		insert_command(IRCommand{IRCommandType::SET, Condition::NE, false, {result}});
+	} else if (to_size <= from_size) {
+		copy(result, Operand::make(value.kind(), to_size, value.id()));
+	} else {
+		// A 32-bit move clears the upper half.
+		uint8_t size{from_size == SZ_E && !from->is_signed() ? SZ_E : to_size};
+		Operand work{work_register(result, size)};
+		insert_command(IRCommand{IRCommandType::MOVE, Condition::ALWAYS, from->is_signed(), {work, value}});
+		copy(result, in_width(work, to_size));
 	}
-	for (Register& reg : registers) reg.in_use = false;
 }
 
-void IntermediateCodeGenerator::expression_statement(const std::shared_ptr<ExpressionStatement>& stmt) {
-	generate_expression(stmt->expr);
+// Arguments past the sixth go on the stack, last first, padded so the
+// stack stays 16-byte aligned at the call.
+void IntermediateCodeGenerator::call(const Instruction& inst) {
+	size_t on_stack{inst.operands.size() > arg_regs.size() ? inst.operands.size() - arg_regs.size() : 0};
+	size_t pushed{on_stack + on_stack % 2};
+
+	if (on_stack % 2 != 0) insert_command(IRCommandType::SUB, reg(RegisterName::Stack), reg(RegisterName::Stack), immediate(SZ_R));
+	for (size_t i{inst.operands.size()}; i-- > arg_regs.size();) {
+		load(inst.operands[i], RegisterName::Ret);
+		insert_command(IRCommandType::PUSH, reg(RegisterName::Ret));
+	}
+	for (size_t i{0}; i < inst.operands.size() && i < arg_regs.size(); i++) {
+		load(inst.operands[i], arg_regs[i]);
+	}
+
+	insert_command(IRCommandType::CALL, symbol(callee_symbols, inst.imm, module.symbols[inst.imm]));
+	if (pushed > 0) insert_command(IRCommandType::ADD, reg(RegisterName::Stack), reg(RegisterName::Stack), immediate(pushed * SZ_R));
+	if (inst.result != NO_ID) copy(location(inst.result), reg(RegisterName::Ret, inst.type->get_size()));
 }
 
-void IntermediateCodeGenerator::variable_declaration_statement(const std::shared_ptr<VariableDeclarationStatement>& stmt) {
-	/*insert_command(
-		IRCommand{
-			IRCommandType::MOVE,
-			std::make_pair(
-				generate_expression(stmt->initializer),
-				ASMValNonRegister{stmt->identifier->type.size, stmt->identifier->identifier.value}
-			)
+// Gives the phis of the blocks this one goes to their operands from it.
+// Each phi is live where its operands are read, so no copy overwrites
+// another's operand.
+void IntermediateCodeGenerator::leave_block(BlockId block) {
+	for (BlockId succ : func->successors(block)) {
+		const BasicBlock& target{func->blocks[succ]};
+		size_t index{(size_t)(std::ranges::find(target.predecessors, block) - target.predecessors.begin())};
+		for (const Instruction& inst : target.instructions) {
+			if (inst.op != Opcode::PHI) break;
+			copy(location(inst.result), location(inst.operands[index]), inst.type->is_signed());
 		}
-	);*/
-	auto offset{create_var(stmt->identifier->identifier.value, stmt->type)};
-	insert_command(IRCommand{IRCommandType::MOVE, std::make_tuple(
-		std::make_shared<ASMValRegister>(stmt->type, offset),
-		generate_expression(stmt->initializer),
-		std::nullopt
-	)});
+	}
 }
 
-void IntermediateCodeGenerator::function_declaration_statement(const std::shared_ptr<FunctionDeclarationStatement>& stmt) {
-	std::string name{mangle_function(stmt)};
-	if (stmt->identifier->identifier.value == "main") {
-		name = stmt->identifier->identifier.value;	
+// Strings stay with the code, which is never written; globals may be.
+void IntermediateCodeGenerator::data() {
+	Operand zstr{symbol(DIRECTIVES::ZSTR)};
+	for (size_t i{0}; i < module.strings.size(); i++) {
+		insert_command(IRCommandType::LABEL, symbol(string_symbols, i, ".STR" + std::to_string(i)));
+		insert_command(IRCommandType::DIRECTIVE, zstr, symbol("\"" + module.strings[i] + "\""));
 	}
-	funcs.insert(std::make_tuple(stmt->identifier->identifier.value, name));
-
-	push_insert_spot(0);
-
-	insert_command(IRCommand{IRCommandType::FUNC, std::make_tuple(
-		std::make_shared<ASMValNonRegister>(stmt->return_type, name),
-		std::nullopt,
-		std::nullopt
-	)});
-	insert_command(IRCommand{IRCommandType::PUSH, std::make_tuple(
-		std::make_shared<ASMValRegister>(create_sz(TypeEnum::U64), occupy_reg(RegisterName::Base)),
-		std::nullopt,
-		std::nullopt
-	)});
-	insert_command(IRCommand{IRCommandType::MOVE, std::make_tuple(
-		std::make_shared<ASMValRegister>(create_sz(TypeEnum::U64), occupy_reg(RegisterName::Base)),
-		std::make_shared<ASMValRegister>(create_sz(TypeEnum::U64), occupy_reg(RegisterName::Stack)),
-		std::nullopt
-	)});
-
-	block_expression(stmt->block, stmt);
-	pop_insert_spot();
-}
+	if (module.globals.empty()) return;
 
+	insert_command(IRCommandType::DIRECTIVE, symbol(DIRECTIVES::DATA));
+	std::map<uint8_t, Operand> widths{
+		{SZ_R, symbol("quad")}, {SZ_E, symbol("long")}, {SZ_X, symbol("short")}, {SZ_H, symbol("byte")}
+	};
+	for (size_t i{0}; i < module.globals.size(); i++) {
+		const SSAGlobal& global{module.globals[i]};
+		insert_command(IRCommandType::LABEL, symbol(global_symbols, i, global.name));
+		insert_command(IRCommand{IRCommandType::DIRECTIVE, Condition::ALWAYS, global.type->is_signed(),
+			{widths.at(global.type->get_size()), immediate(global.init)}});
+	}
+}
@@ -1,12 +1,16 @@
 #pragma once
 
-#include <memory>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
 #include <ranges>
-#include <stack>
-#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "Lexer.h"
-#include "Syntax.h"
-#include "Environment.h"
+#include "SSA.h"
 #include "Types.h"
 
 constexpr uint8_t SZ_R{8u};
@@ -15,7 +19,7 @@ constexpr uint8_t SZ_X{2u};
 constexpr uint8_t SZ_H{1u};
 constexpr uint8_t SZ_L{1u};
 
-enum class IRCommandType {
+enum class IRCommandType : uint8_t {
 	MOVE,
 	ADD,
 	SUB,
@@ -31,11 +35,17 @@ enum class IRCommandType {
 	POP,
 	LEA,
 	DIRECTIVE,
-	LEAVE
+	LEAVE,
+	COMPARE,
+	// Set a byte register to whether the command's condition holds.
+	SET,
+	// To the label in the first argument, if the command's condition holds.
+	JUMP
 };
 
 namespace DIRECTIVES {
 	const std::string ZSTR{"asciz"};
+	const std::string DATA{"data"};
 };
 
 enum class RegisterName {
@@ -69,123 +79,83 @@ Register* get_next_reg(bool occupy = false, bool include_important = false);
 Register* occupy_reg(const RegisterName& name);
 Register* get_reg(const RegisterName& name, bool occupy = false);
 
-static std::shared_ptr<TConstructor> create_sz(TypeEnum t) {
-	return std::make_shared<TConstructor>(types.at(t));
-}
-
-struct ASMValHolder {
-	ASMValHolder() { }
-	ASMValHolder(const Type& type) : held_type{type} { }
-
-	Type held_type{};
-
-	virtual void print(std::ostream& os = std::cout) const noexcept = 0;
+static std::vector<Register> registers{ // Can't be const
+	{RegisterName::Ret},
+	{RegisterName::Arg1}, {RegisterName::Arg2}, {RegisterName::Arg3}, {RegisterName::Arg4}, {RegisterName::Arg5}, {RegisterName::Arg6},
+	{RegisterName::CP1}, {RegisterName::CP2}, {RegisterName::CP3}, {RegisterName::CP4}, {RegisterName::CP5},
+	{RegisterName::GP1}, {RegisterName::GP2},
+	{RegisterName::Stack, true}, {RegisterName::Base, true}, {RegisterName::Instruction, true},
 };
 
-struct ASMValRegister : public ASMValHolder {
-	ASMValRegister() { }
-	ASMValRegister(const Type& held_type, const std::optional<int>& offset)
-		: ASMValHolder{held_type}, reg{get_reg(RegisterName::Base)},
-		reg_size{SZ_R}, offset{offset} { }
-	ASMValRegister(const Type& held_type, Register* reg)
-		: ASMValHolder{held_type}, reg{reg}, reg_size{held_type->get_size()} { }
-	ASMValRegister(const Type& held_type, Register* reg, bool dereferenced)
-		: ASMValHolder{held_type}, reg{reg},
-		dereferenced{dereferenced}, reg_size{SZ_R} { }
+// The flags a SET or JUMP tests, as the COMPARE before it left them.
+enum class Condition : uint8_t {
+	ALWAYS, E, NE, L, LE, G, GE, B, BE, A, AE
+};
 
-	Register* reg{};
-	uint8_t reg_size{};
-	std::optional<int> offset{std::nullopt};
-	bool dereferenced{};
+enum class OperandKind : uint8_t {
+	NONE,
+	REGISTER,
+	// At an offset from the frame base.
+	FRAME,
+	// At the address held in a register.
+	INDIRECT,
+	// An index into the module's immediates.
+	IMMEDIATE,
+	// An index into the module's symbols: a function, label or directive
+	// argument. As an instruction operand, it is the memory at the symbol,
+	// addressed relative to the instruction so the code stays relocatable.
+	SYMBOL
+};
 
-	bool operator==(const ASMValRegister& reg) const noexcept {
-		return (comp_types(held_type, reg.held_type) && *this->reg == *reg.reg &&
-				reg_size == reg.reg_size && offset == offset &&
-				dereferenced == reg.dereferenced);
+// An operand in 32 bits: its kind in the low three, the log2 of the width
+// it is accessed at in the next two, and the register, frame offset or
+// table index in the rest.
+struct Operand {
+	static Operand make(OperandKind kind, uint8_t size, int32_t id) noexcept {
+		uint32_t width{size >= SZ_R ? 3u : size >= SZ_E ? 2u : size >= SZ_X ? 1u : 0u};
+		return Operand{(uint32_t)kind | width << 3 | (uint32_t)id << 5};
 	}
-
-	void print(std::ostream& os) const noexcept override {
-		static std::vector<std::string> reg_strs{
-			"RET", "ARG1", "ARG2", "ARG3", "ARG4", "ARG5", "ARG6",
-			"CP1", "CP2", "CP3", "CP4", "CP5",
-			"GP1", "GP2",
-			"STACK", "BASE", "INSTRUCTION"
-		};
-		os << "% (sz" << reg_size << ")" << reg_strs[(size_t)reg->name];
-		if (offset.has_value()) os << "-" << offset.value();
-		os << std::endl;
+	static Operand reg(RegisterName name, uint8_t size = SZ_R) noexcept {
+		return make(OperandKind::REGISTER, size, (int32_t)name);
 	}
-};
-
-struct ASMValNonRegister : public ASMValHolder {
-	ASMValNonRegister() { }
-	ASMValNonRegister(const Type& held_type, const std::string& value)
-		: ASMValHolder{held_type}, value{value} { }
-
-	std::string value{};
-
-	void print(std::ostream& os) const noexcept override {
-		os << value << std::endl;
+	static Operand frame(int offset, uint8_t size) noexcept { return make(OperandKind::FRAME, size, offset); }
+	static Operand indirect(RegisterName name, uint8_t size) noexcept {
+		return make(OperandKind::INDIRECT, size, (int32_t)name);
 	}
 
-	bool operator==(const ASMValNonRegister& non) const noexcept {
-		return (comp_types(held_type, non.held_type) && value == non.value);
-	}
-};
+	OperandKind kind() const noexcept { return (OperandKind)(bits & 7u); }
+	uint8_t size() const noexcept { return (uint8_t)(1u << (bits >> 3 & 3u)); }
+	int32_t id() const noexcept { return (int32_t)bits >> 5; }
+	RegisterName reg_name() const noexcept { return (RegisterName)id(); }
 
-using ASMVal = std::shared_ptr<ASMValHolder>;
+	bool has_value() const noexcept { return kind() != OperandKind::NONE; }
+	bool is_memory() const noexcept { return kind() == OperandKind::FRAME || kind() == OperandKind::INDIRECT; }
 
-static bool comp_asm_val(const ASMVal& lhs, const ASMVal& rhs) noexcept {
-	if (auto lhs_reg{std::dynamic_pointer_cast<ASMValRegister>(lhs)}) {
-		if (auto rhs_reg{std::dynamic_pointer_cast<ASMValRegister>(rhs)}) {
-			return *lhs_reg == *rhs_reg;
-		} else {
-			return false;
-		}
-	} else {
-		if (auto rhs_non{std::dynamic_pointer_cast<ASMValNonRegister>(rhs)}) {
-			return *std::dynamic_pointer_cast<ASMValNonRegister>(lhs) == *rhs_non;
-		} else {
-			return false;
-		}
-	}
-}
+	bool operator==(const Operand&) const noexcept = default;
 
-static std::vector<Register> registers{ // Can't be const
-	{RegisterName::Ret},
-	{RegisterName::Arg1}, {RegisterName::Arg2}, {RegisterName::Arg3}, {RegisterName::Arg4}, {RegisterName::Arg5}, {RegisterName::Arg6},
-	{RegisterName::CP1}, {RegisterName::CP2}, {RegisterName::CP3}, {RegisterName::CP4}, {RegisterName::CP5},
-	{RegisterName::GP1}, {RegisterName::GP2},
-	{RegisterName::Stack, true}, {RegisterName::Base, true}, {RegisterName::Instruction, true},
+	uint32_t bits{};
 };
 
+// Holds no pointers: operands refer into the tables of the module the
+// command is in.
 struct IRCommand {
 	IRCommandType type{};
-	std::tuple<std::optional<ASMVal>, std::optional<ASMVal>, std::optional<ASMVal>> args{};
-
-	inline friend std::ostream& operator<<(std::ostream& os, const IRCommand& cmd) noexcept;
+	Condition condition{};
+	// Moves sign-extend, divisions are signed and immediates read as signed.
+	bool is_signed{};
+	std::array<Operand, 3> args{};
 };
+static_assert(sizeof(IRCommand) == 16);
 
-inline std::ostream& operator<<(std::ostream& os, const IRCommand& cmd) noexcept {
-	static std::vector<std::string> cmd_strs{
-		"MOVE", "ADD", "SUB", "MULT", "DIV", "GOTO", "XOR", "NEG", "CALL", "RET", "FUNC", "LABEL", "PUSH", "POP"
-	};
-	static std::vector<std::string> reg_strs{
-		"RET", "ARG1", "ARG2", "ARG3", "ARG4", "ARG5", "ARG6",
-		"CP1", "CP2", "CP3", "CP4", "CP5",
-		"GP1", "GP2",
-		"Stack", "Base", "Instruction"
-	};
-
-	os << cmd_strs[(int)cmd.type] << " ";
+struct IRModule {
+	std::vector<IRCommand> commands{};
+	std::vector<uint64_t> immediates{};
+	std::vector<std::string> symbols{};
 
-	if (std::get<0>(cmd.args).has_value()) std::get<0>(cmd.args).value()->print(os);
-	if (std::get<1>(cmd.args).has_value()) { os << ", "; std::get<1>(cmd.args).value()->print(os); }
-	
-	return os;
-}
+	friend std::ostream& operator<<(std::ostream& os, const IRModule& ir);
+};
 
-void unoccupy_if_reg(ASMVal& value);
+void unoccupy_if_reg(Operand value);
 
 static int ceiling_multiple(int number, int multiple) {
 	int ret{(int)ceil((double)std::abs(number) / multiple) * multiple};
@@ -193,70 +163,63 @@ static int ceiling_multiple(int number, int multiple) {
 	else return -ret;
 }
 
+// Lowers SSA to commands shaped after x86-64. Values are given registers
+// by a linear scan over the function, and frame slots when they run out;
+// constants that fit in an instruction are used as immediates. A register
+// holds its value in the bits the value's type has, and whatever is above
+// them is undefined. Phis become copies: each predecessor writes its
+// operand to the phi before it leaves.
 class IntermediateCodeGenerator {
 public:
-	IntermediateCodeGenerator(const std::vector<std::shared_ptr<Statement>>& stmts)
-		: stmts{stmts} { }
+	explicit IntermediateCodeGenerator(const SSAModule& module)
+		: module{module} { }
 
-	std::vector<IRCommand> run();
+	// Hands over the IR; call once.
+	IRModule run();
 
 private:
-	std::vector<std::shared_ptr<Statement>> stmts{};
-	std::vector<IRCommand> commands{};
-	size_t commands_insert{0};
-
-	std::vector<size_t> insert_jumps{};
-
-	bool is_signed(const Type& t) {
-		if (is_pointer(t)) return false;
-		else return std::dynamic_pointer_cast<TConstructor>(t)->type.is_signed;
+	const SSAModule& module;
+	IRModule ir{};
+	std::unordered_map<uint64_t, int32_t> immediate_ids{};
+	// The symbol made for each of the module's symbols, strings and
+	// globals, if one has been.
+	std::vector<Operand> callee_symbols{};
+	std::vector<Operand> string_symbols{};
+	std::vector<Operand> global_symbols{};
+
+	// Where the function being lowered keeps each value: nowhere if nothing
+	// reads it. Its slots and the registers it saves are below its frame base.
+	const SSAFunction* func{};
+	std::vector<Operand> value_location{};
+	std::vector<int> slot_offset{};
+	std::vector<std::pair<RegisterName, int>> saved_registers{};
+	std::vector<Operand> block_labels{};
+
+	void insert_command(IRCommandType type, Operand arg1 = {}, Operand arg2 = {}, Operand arg3 = {}) {
+		ir.commands.push_back(IRCommand{type, Condition::ALWAYS, false, {arg1, arg2, arg3}});
 	}
-
-	void insert_command(const IRCommand& command);
-	void push_insert_spot(size_t insert);
-	void pop_insert_spot();
-
-	int create_var(const std::string& identifier, const Type& type, bool neg = true);
-
-	std::string mangle_type(const std::string& t);
-	std::string mangle_function(const std::shared_ptr<FunctionDeclarationStatement>& func);
-
-	ASMVal generate_expression(const std::shared_ptr<Expression>& expr);
-	ASMVal identifier_expression(const std::shared_ptr<IdentifierExpression>& expr);
-	ASMVal literal_expression(const std::shared_ptr<LiteralExpression>& expr);
-	ASMVal grouping_expression(const std::shared_ptr<GroupingExpression>& expr);
-	ASMVal unary_expression(const std::shared_ptr<UnaryExpression>& expr);
-	ASMVal binary_expression(const std::shared_ptr<BinaryExpression>& expr);
-	ASMVal block_expression(const std::shared_ptr<BlockExpression>& expr, const std::shared_ptr<FunctionDeclarationStatement>& func = nullptr);
-	ASMVal call_expression(const std::shared_ptr<CallExpression>& expr);
-	ASMVal return_expression(const std::shared_ptr<ReturnExpression>& expr, const std::shared_ptr<FunctionDeclarationStatement>& func = nullptr);
-	ASMVal cast_expression(const std::shared_ptr<CastExpression>& expr);
-
-	void generate_statement(const std::shared_ptr<Statement>& stmt);
-	void expression_statement(const std::shared_ptr<ExpressionStatement>& stmt);
-	void variable_declaration_statement(const std::shared_ptr<VariableDeclarationStatement>& stmt);
-	void function_declaration_statement(const std::shared_ptr<FunctionDeclarationStatement>& stmt);
-
-	std::stack<std::string> env_stack{};
-	std::map<std::string, std::string> funcs{};
-
-	struct StackVar {
-		std::string name{};
-		Type type{};
-		int pos{};
-	};
-
-	struct Stack {
-		int pos_size{16};
-		int neg_size{};
-		std::vector<StackVar> vars{};
-		bool call_function{};
-	};
-	std::stack<Stack> stacks{};
-
-	const std::string BLOCK_ENV_STACK_NAME{"%_"};
-	unsigned long long block_index{0};
-
-	unsigned long long str_count{0};
+	void insert_command(const IRCommand& command) { ir.commands.push_back(command); }
+
+	static Operand reg(RegisterName name, uint8_t size = SZ_R) { return Operand::reg(name, size); }
+	Operand immediate(uint64_t value);
+	Operand symbol(std::string name);
+	Operand symbol(std::vector<Operand>& made, size_t index, const std::string& name);
+	Operand location(ValueId value) const { return value_location[value]; }
+
+	void load(ValueId value, RegisterName name);
+	void load(Operand from, bool is_signed, RegisterName name);
+	void copy(Operand to, Operand from, bool is_signed = false);
+
+	void function(const SSAFunction& func, size_t index);
+	int allocate(const std::vector<BlockId>& order);
+	void instruction(const Instruction& inst, BlockId block, BlockId next);
+	void address(const Instruction& inst, Operand target);
+	void unary(const Instruction& inst);
+	void arithmetic(const Instruction& inst);
+	void divide(const Instruction& inst);
+	void compare(const Instruction& inst);
+	void cast(const Instruction& inst);
+	void call(const Instruction& inst);
+	void leave_block(BlockId block);
+	void data();
 };
-
@@ -1,14 +1,26 @@
 #include "Lexer.h"
 #include "ErrorHandling.h"
 
-std::vector<Token> Lexer::run() {
+Token Lexer::next() {
 	while (!is_at_end()) {
 		start = current;
 		scan_token();
-    }
+		if (scanned.has_value()) {
+			Token tok{scanned.value()};
+			scanned.reset();
+			return tok;
+		}
+	}
 
-    tokens.push_back({"", TokenType::END_OF_FILE, line});
-    return tokens;
+	return {source.substr(source.size()), TokenType::END_OF_FILE};
+}
+
+std::vector<Token> Lexer::run() {
+	std::vector<Token> tokens{};
+	do {
+		tokens.push_back(next());
+	} while (tokens.back().type != TokenType::END_OF_FILE);
+	return tokens;
 }
 
 void Lexer::scan_token() {
@@ -32,7 +44,7 @@ void Lexer::scan_token() {
 		case '*': add_token(TokenType::STAR); break; 
 		case '/':
 			if (match('/')) {
-				while (peek() != '\n' && !is_at_end()) advance();
+				skip_to(find_byte(cursor(), source_end(), '\n'));
 			} else {
 				add_token(TokenType::SLASH);
 			}
@@ -62,9 +74,8 @@ void Lexer::scan_token() {
 		case ' ':
 		case '\r':
 		case '\t':
-			break;
 		case '\n':
-			line++;
+			skip_to(scan.skip_whitespace(cursor(), source_end()));
 			break;
 
 		default:
@@ -73,81 +84,57 @@ void Lexer::scan_token() {
 			} else if (std::isalpha(c) || c == '_') {
 				identifier();
 			} else {
-				error(line, "Unknown character."); break;
+				error(line(), "Unknown character."); break;
 			}
 	}
 }
 
 void Lexer::string() {
-	while (peek() != '"' && !is_at_end()) {
-		if (peek() == '\n') line++;
-		advance();
-    }
+	skip_to(find_byte(cursor(), source_end(), '"'));
 
     if (is_at_end()) {
-		error(line, "Unterminated string.");
+		error(line(), "Unterminated string.");
 		return;
     }
 
     advance();
 
-    tokens.push_back({source.substr(start + 1, current-start-2), TokenType::STRING_LITERAL, line});
+    scanned = Token{source.substr(start + 1, current-start-2), TokenType::STRING_LITERAL};
 }
 
 void Lexer::char_lit() {
-	while (peek() != '\'' && !is_at_end()) {
-		if (peek() == '\n') line++;
-		advance();
-    }
+	skip_to(find_byte(cursor(), source_end(), '\''));
 
 	if (start - current > 1) {
-		error(line, "Character literal can only be one character long.");
+		error(line(), "Character literal can only be one character long.");
 	}
 
     if (is_at_end()) {
-		error(line, "Unterminated character literal.");
+		error(line(), "Unterminated character literal.");
 		return;
     }
 
     advance();
 
-    tokens.push_back({source.substr(start + 1, current-start-2), TokenType::CHAR_LITERAL, line});
+    scanned = Token{source.substr(start + 1, current-start-2), TokenType::CHAR_LITERAL};
 }
 
 void Lexer::number(bool negative) {
-	while (std::isdigit(peek())) advance();
-
-	int current{this->current};
-	int start{this->start};
-	this->start = this->current;
-
-	identifier();
-
-	std::vector<TokenType> types{
-		  number_types
-		| std::views::values
-		| std::views::transform([](const RealType& t) { return t.keyword.second; })
-		| std::ranges::to<std::vector>()
-	};
-	if (std::ranges::find(types, tokens.back().type) == types.end()) {
-		this->current = current;
+	skip_to(scan.number_end(cursor(), source_end()));
+
+	// A numeric type keyword straight after the digits is their suffix; any
+	// other name is left to the next token.
+	int digits_end{current};
+	skip_to(scan.identifier_end(cursor(), source_end()));
+	if (!is_number_type_token(keyword_table.lookup(source.substr(digits_end, current - digits_end)))) {
+		current = digits_end;
 	}
 
-	this->start = start;
-
-	tokens.pop_back();
 	add_token(TokenType::NUMBER_LITERAL);
 }
 
 void Lexer::identifier() {
-	while (std::isalnum(peek()) || peek() == '_') advance();
-	std::string text{source.substr(start, current-start)};
-    TokenType type{};
-	try {
-		type = keywords.at(text);
-	} catch (const std::exception& e) {
-		type = TokenType::IDENTIFIER;
-	}
-    add_token(type);
+	skip_to(scan.identifier_end(cursor(), source_end()));
+	add_token(keyword_table.lookup(source.substr(start, current-start)));
 }
 
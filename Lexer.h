@@ -1,14 +1,22 @@
 #pragma once
 
+#include <array>
+#include <initializer_list>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 #include <ostream>
 #include <map>
 #include <ranges>
 #include <memory>
+#include "Source.h"
+#include "Scan.h"
+#include "Symbol.h"
 
-enum class TokenType {
+enum class TokenType : uint8_t {
 	// Standard operators.
 	LEFT_PAREN, RIGHT_PAREN, LEFT_BRACE, RIGHT_BRACE,
 	COMMA, DOT, MINUS, PLUS, SEMICOLON, SLASH, STAR,
@@ -37,12 +45,17 @@ enum class TokenType {
 	END_OF_FILE
 };
 
-static const std::map<std::string, TokenType> keywords{
-	{"i8",    TokenType::I8},
+struct Keyword {
+	std::string_view text{};
+	TokenType type{};
+};
+
+inline constexpr std::array<Keyword, 19> keywords{{
+	{"i8",     TokenType::I8},
 	{"i16",    TokenType::I16},
 	{"i32",    TokenType::I32},
 	{"i64",    TokenType::I64},
-	{"u8",    TokenType::U8},
+	{"u8",     TokenType::U8},
 	{"u16",    TokenType::U16},
 	{"u32",    TokenType::U32},
 	{"u64",    TokenType::U64},
@@ -56,10 +69,75 @@ static const std::map<std::string, TokenType> keywords{
 	{"while",  TokenType::WHILE},
 	{"true",   TokenType::TRUE},
 	{"false",  TokenType::FALSE},
-	{"as",  TokenType::AS}
+	{"as",     TokenType::AS}
+}};
+
+// Perfect hash over the keywords; the seed is searched for at compile
+// time. A lookup hashes the length and three characters, loads one slot
+// and does one compare. Anything that misses is an identifier.
+class KeywordTable {
+public:
+	consteval KeywordTable() {
+		while (!place_all()) seed++;
+	}
+
+	constexpr TokenType lookup(std::string_view text) const noexcept {
+		if (text.size() < MIN_LENGTH || text.size() > MAX_LENGTH) return TokenType::IDENTIFIER;
+		const Keyword& keyword{slots[slot(text, seed)]};
+		return (keyword.text == text ? keyword.type : TokenType::IDENTIFIER);
+	}
+
+private:
+	static constexpr size_t SLOT_BITS{6u};
+	static constexpr size_t MIN_LENGTH{2u};
+	static constexpr size_t MAX_LENGTH{6u};
+
+	std::array<Keyword, 1u << SLOT_BITS> slots{};
+	uint32_t seed{};
+
+	static constexpr uint32_t slot(std::string_view text, uint32_t seed) noexcept {
+		uint32_t key{
+			(uint32_t)(uint8_t)text[0] | (uint32_t)(uint8_t)text[1] << 8 |
+			(uint32_t)(uint8_t)text.back() << 16 | (uint32_t)text.size() << 24
+		};
+		key = (key ^ seed) * 0x9E3779B1u;
+		key ^= key >> 15;
+		return (key * 0x85EBCA6Bu) >> (32u - SLOT_BITS);
+	}
+
+	constexpr bool place_all() {
+		slots = {};
+		for (const Keyword& keyword : keywords) {
+			Keyword& entry{slots[slot(keyword.text, seed)]};
+			if (!entry.text.empty()) return false;
+			entry = keyword;
+		}
+		return true;
+	}
 };
 
-static const std::vector<TokenType> literal_tokens{
+inline constexpr KeywordTable keyword_table{};
+
+// A set of token kinds packed into one word, so membership is a shift
+// and a mask and sets can be built at compile time.
+class TokenSet {
+public:
+	constexpr TokenSet() { }
+	constexpr TokenSet(std::initializer_list<TokenType> types) {
+		for (TokenType type : types) bits |= bit(type);
+	}
+
+	constexpr bool contains(TokenType type) const noexcept { return (bits & bit(type)) != 0u; }
+
+private:
+	uint64_t bits{};
+
+	static constexpr uint64_t bit(TokenType type) noexcept { return uint64_t{1} << (size_t)type; }
+};
+
+static_assert((size_t)TokenType::END_OF_FILE < 64, "TokenSet holds at most 64 token kinds.");
+
+inline constexpr TokenSet literal_tokens{
 	TokenType::IDENTIFIER, TokenType::STRING_LITERAL,
 	TokenType::NUMBER_LITERAL, TokenType::CHAR_LITERAL,
 	TokenType::TRUE, TokenType::FALSE
@@ -71,17 +149,17 @@ enum class TypeEnum {
 
 class RealType {
 public:
-	RealType() { }
-	RealType(std::pair<std::string, TokenType> keyword, uint8_t size)
-		: keyword{keyword}, size{size} { }
+	constexpr RealType() { }
+	constexpr RealType(std::pair<std::string_view, TokenType> keyword, uint8_t size, bool is_signed = false)
+		: keyword{keyword}, size{size}, is_signed{is_signed} { }
 
-	bool operator==(const RealType& type) const {
+	constexpr bool operator==(const RealType& type) const {
 		return keyword == type.keyword && size == type.size && is_signed == type.is_signed;
 	}
-	bool operator!=(const RealType& type) const { return !(*this == type); }
+	constexpr bool operator!=(const RealType& type) const { return !(*this == type); }
 	friend inline std::ostream& operator<<(std::ostream& os, const RealType& type);
 
-	std::pair<std::string, TokenType> keyword{};
+	std::pair<std::string_view, TokenType> keyword{};
 	uint8_t size{};
 	bool is_signed{};
 };
@@ -91,69 +169,111 @@ inline std::ostream& operator<<(std::ostream& os, const RealType& type) {
 	return os;
 }
 
-static const std::map<TypeEnum, RealType> types{
-	{TypeEnum::I8, {*keywords.find("i8"), sizeof(int8_t)}},
-	{TypeEnum::I16, {*keywords.find("i16"), sizeof(int16_t)}},
-	{TypeEnum::I32, {*keywords.find("i32"), sizeof(int32_t)}},
-	{TypeEnum::I64, {*keywords.find("i64"), sizeof(int64_t)}},
-	{TypeEnum::U8, {*keywords.find("u8"), sizeof(uint8_t)}},
-	{TypeEnum::U16, {*keywords.find("u16"), sizeof(uint16_t)}},
-	{TypeEnum::U32, {*keywords.find("u32"), sizeof(uint32_t)}},
-	{TypeEnum::U64, {*keywords.find("u64"), sizeof(uint64_t)}},
-	{TypeEnum::BOOL, {*keywords.find("bool"), sizeof(int8_t)}},
-	{TypeEnum::NONE, {*keywords.find("none"), 0u}}
+// Indexed by TypeEnum; the first NUMBER_TYPE_COUNT entries are the number types.
+struct TypeTable : std::array<RealType, 10> {
+	constexpr const RealType& at(TypeEnum type) const { return (*this)[(size_t)type]; }
 };
 
-static const std::map<TypeEnum, RealType> number_types{
-	*types.find(TypeEnum::I8), *types.find(TypeEnum::I16),
-	*types.find(TypeEnum::I32), *types.find(TypeEnum::I64),
-	*types.find(TypeEnum::U8), *types.find(TypeEnum::U16),
-	*types.find(TypeEnum::U32), *types.find(TypeEnum::U64)
-};
+inline constexpr TypeTable types{{
+	RealType{{"i8", TokenType::I8}, sizeof(int8_t), true},
+	RealType{{"i16", TokenType::I16}, sizeof(int16_t), true},
+	RealType{{"i32", TokenType::I32}, sizeof(int32_t), true},
+	RealType{{"i64", TokenType::I64}, sizeof(int64_t), true},
+	RealType{{"u8", TokenType::U8}, sizeof(uint8_t)},
+	RealType{{"u16", TokenType::U16}, sizeof(uint16_t)},
+	RealType{{"u32", TokenType::U32}, sizeof(uint32_t)},
+	RealType{{"u64", TokenType::U64}, sizeof(uint64_t)},
+	RealType{{"bool", TokenType::BOOL}, sizeof(int8_t)},
+	RealType{{"none", TokenType::NONE}, 0u}
+}};
+
+inline constexpr size_t NUMBER_TYPE_COUNT{8u};
+inline constexpr std::span<const RealType> number_types{types.data(), NUMBER_TYPE_COUNT};
 
-static std::vector<TokenType> type_tokens() {
-	std::vector<TokenType> t{types | std::views::values | std::views::transform([](const auto& type) {
-		return type.keyword.second;
-	}) | std::ranges::to<std::vector>()};
-	t.insert(t.end(), TokenType::AUTO);
-	return t;
+// Maps a token kind to its index in `types`, or -1 if it does not name one.
+inline constexpr auto token_type_index{[] {
+	std::array<int8_t, (size_t)TokenType::END_OF_FILE + 1> index{};
+	index.fill(-1);
+	for (size_t i{0}; i < types.size(); i++) {
+		index[(size_t)types[i].keyword.second] = (int8_t)i;
+	}
+	return index;
+}()};
+
+constexpr bool is_type_token(TokenType type) noexcept {
+	return token_type_index[(size_t)type] >= 0 || type == TokenType::AUTO;
 }
 
+constexpr bool is_number_type_token(TokenType type) noexcept {
+	int8_t index{token_type_index[(size_t)type]};
+	return index >= 0 && (size_t)index < NUMBER_TYPE_COUNT;
+}
+
+constexpr bool is_number_type(const RealType& type) noexcept {
+	return is_number_type_token(type.keyword.second) && types[token_type_index[(size_t)type.keyword.second]] == type;
+}
+
+// A token is a view into the source buffer: 16 bytes, no ownership.
+// Tokens made from string literals (native function names, defaults)
+// point at static storage and report line 0. Identifiers are interned on
+// construction and carry their symbol in the bytes after the type.
 struct Token {
-	std::string value{};
-	TokenType type{};
-	unsigned int line{};
+	constexpr Token() { }
+	Token(std::string_view text, TokenType type = TokenType::IDENTIFIER)
+		: start{text.data()}, length{(uint32_t)text.size()}, type{type},
+		symbol{type == TokenType::IDENTIFIER ? intern(text) : 0u} { }
+
+	const char* start{""};
+	uint32_t length{};
+	TokenType type : 8 {};
+	Symbol symbol : 24 {};
 
-	bool operator<(const Token& tok) const noexcept { return value.compare(tok.value) < 0; }
+	std::string_view text() const noexcept { return {start, length}; }
+	unsigned int line() const { return SourceMap::line_of(start); }
+
+	bool operator<(const Token& tok) const noexcept { return text() < tok.text(); }
 	friend inline std::ostream& operator<<(std::ostream& os, const Token& tok);
 };
 
+static_assert(sizeof(Token) <= 16);
+
 inline std::ostream& operator<<(std::ostream& os, const Token& tok) {
-	os << std::to_string((int)tok.type) + ": " + tok.value + " (line " + std::to_string(tok.line) + ")";
+	os << (int)tok.type << ": " << tok.text() << " (line " << tok.line() << ")";
 	return os;
 }
 
-static std::optional<RealType> token_to_type(const Token& token) {
-	for (const RealType& type : types | std::views::values) {
-		if (type.keyword.second == token.type) return type;
-	}
-	return std::nullopt;
+constexpr std::optional<RealType> token_to_type(const Token& token) noexcept {
+	int8_t index{token_type_index[(size_t)token.type]};
+	if (index < 0) return std::nullopt;
+	return types[index];
 }
 
 class Lexer {
 public:
 	Lexer() { }
-	Lexer(const std::string& source) : source{source} { }
+	Lexer(std::string_view source) : source{source} { SourceMap::reset(source); }
+
+	// Lexes one piece of a source that SourceMap already covers, leaving the
+	// map alone so that line numbers stay relative to the whole source.
+	static Lexer for_chunk(std::string_view chunk) {
+		Lexer lexer{};
+		lexer.source = chunk;
+		return lexer;
+	}
+
+	// Scans up to and returns the next token. Keeps returning
+	// END_OF_FILE once the source is exhausted.
+	Token next();
 	std::vector<Token> run();
 
 private:
-	std::string source{};
+	std::string_view source{};
+	const ScanKernels& scan{scan_kernels()};
 
 	int start{};
 	int current{};
-	unsigned int line{1u};
 
-	std::vector<Token> tokens{};
+	std::optional<Token> scanned{};
 
 	bool is_at_end() { return current >= source.size(); }
 
@@ -165,8 +285,13 @@ private:
 		return source[current];
 	}
 	void add_token(TokenType type) {
-		tokens.push_back({source.substr(start, current-start), type, line});
+		scanned = Token{source.substr(start, current-start), type};
 	}
+	unsigned int line() const { return SourceMap::line_of(cursor()); }
+
+	const char* cursor() const { return source.data() + current; }
+	const char* source_end() const { return source.data() + source.size(); }
+	void skip_to(const char* at) { current = (int)(at - source.data()); }
 
 	bool match(char expected) {
 		if (is_at_end()) return false;
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <ranges>
+#include "Monomorphizer.h"
+#include "Stack.h"
+
+Type Monomorphizer::substitute(Type type, std::span<const Token> params, std::span<const Type> args) {
+	if (stack_exhausted()) return on_new_stack([&] { return substitute(type, params, args); });
+	if (auto param{type_cast<TParameter>(type)}) {
+		for (size_t i{0}; i < params.size(); i++) {
+			if (params[i].symbol == param->name) return args[i];
+		}
+		return type;
+	} else if (auto ptr{type_cast<TPointer>(type)}) {
+		Type inner{substitute(ptr->inner, params, args)};
+		return (inner == ptr->inner ? type : Type::pointer_to(inner));
+	} else if (auto cons{type_cast<TConstructor>(type)}) {
+		if (cons->generics.empty()) return type;
+		std::vector<Type> generics{(cons->generics | std::views::transform([&](Type generic) {
+			return substitute(generic, params, args);
+		})) | std::ranges::to<std::vector>()};
+		return Type::constructor(cons->type, generics);
+	}
+	return type;
+}
+
+FunctionDeclarationStatement* Monomorphizer::instantiate(FunctionDeclarationStatement* generic, std::span<const Type> args, bool& created) {
+	std::vector<uint32_t> key{(args | std::views::transform([](Type arg) { return arg.id; })) | std::ranges::to<std::vector>()};
+	auto [it, inserted]{instances[generic].try_emplace(std::move(key))};
+	created = inserted;
+	if (!inserted) return it->second;
+
+	std::string name{symbol_name(generic->identifier->identifier.symbol)};
+	name += '<';
+	for (size_t i{0}; i < args.size(); i++) {
+		if (i > 0) name += ", ";
+		name += type_name(args[i]);
+	}
+	name += '>';
+
+	bound_params = generic->type_params;
+	bound_args.assign(args.begin(), args.end());
+	// The symbol table keeps the name's text for good, so the token can view it.
+	FunctionDeclarationStatement* instance{clone_function(generic, Token{symbol_name(intern(name))})};
+	instance->type_params.clear();
+	instance->generic = generic;
+	instance->type_args.assign(args.begin(), args.end());
+
+	it->second = instance;
+	return instance;
+}
+
+Expression* Monomorphizer::clone(Expression* expr) {
+	if (stack_exhausted()) return on_new_stack([&] { return clone(expr); });
+	return visit(expr, overloaded{
+		[&](IdentifierExpression* id) -> Expression* { return arena.make<IdentifierExpression>(id->identifier); },
+		[&](LiteralExpression* lit) -> Expression* { return arena.make<LiteralExpression>(lit->value); },
+		[&](GroupingExpression* group) -> Expression* { return arena.make<GroupingExpression>(clone(group->expr)); },
+		[&](UnaryExpression* un) -> Expression* { return arena.make<UnaryExpression>(un->op, clone(un->expr)); },
+		[&](BinaryExpression* bin) -> Expression* {
+			Expression* lhs{clone(bin->sides.first)};
+			return arena.make<BinaryExpression>(lhs, bin->op, clone(bin->sides.second));
+		},
+		[&](BlockExpression* block) -> Expression* { return clone_block(block); },
+		[&](CallExpression* call) -> Expression* {
+			Expression* callee{clone(call->callee)};
+			size_t first{expression_scratch.size()};
+			for (Expression* arg : call->args) {
+				Expression* copy{clone(arg)};
+				expression_scratch.push_back(copy);
+			}
+			auto args{arena.copy(std::span{expression_scratch}.subspan(first))};
+			expression_scratch.resize(first);
+			return arena.make<CallExpression>(callee, call->closing_paren, args);
+		},
+		[&](ReturnExpression* ret) -> Expression* {
+			Expression* value{ret->return_expression != nullptr ? clone(ret->return_expression) : nullptr};
+			return arena.make<ReturnExpression>(ret->return_tok, value);
+		},
+		[&](CastExpression* cast) -> Expression* {
+			return arena.make<CastExpression>(clone(cast->expr), cast->as, substitute(cast->cast_type));
+		},
+	});
+}
+
+Statement* Monomorphizer::clone(Statement* stmt) {
+	if (stmt == nullptr) return nullptr;
+	if (stack_exhausted()) return on_new_stack([&] { return clone(stmt); });
+	return visit(stmt, overloaded{
+		[&](ExpressionStatement* expr) -> Statement* { return arena.make<ExpressionStatement>(clone(expr->expr)); },
+		[&](VariableDeclarationStatement* decl) -> Statement* {
+			return arena.make<VariableDeclarationStatement>(
+				substitute(decl->type),
+				arena.make<IdentifierExpression>(decl->identifier->identifier),
+				clone(decl->initializer)
+			);
+		},
+		[&](FunctionDeclarationStatement* func) -> Statement* {
+			// A nested generic's own type parameters hide the outer ones of the same name.
+			std::vector<Token> outer_params{bound_params};
+			std::vector<Type> outer_args{bound_args};
+			for (const Token& param : func->type_params) {
+				for (size_t i{0}; i < bound_params.size(); i++) {
+					if (bound_params[i].symbol != param.symbol) continue;
+					bound_params.erase(bound_params.begin() + i);
+					bound_args.erase(bound_args.begin() + i);
+					break;
+				}
+			}
+			FunctionDeclarationStatement* copy{clone_function(func, func->identifier->identifier)};
+			bound_params = std::move(outer_params);
+			bound_args = std::move(outer_args);
+			return copy;
+		},
+	});
+}
+
+BlockExpression* Monomorphizer::clone_block(BlockExpression* block) {
+	size_t first{statement_scratch.size()};
+	for (Statement* stmt : block->statements) {
+		Statement* copy{clone(stmt)};
+		statement_scratch.push_back(copy);
+	}
+	auto stmts{arena.copy(std::span{statement_scratch}.subspan(first))};
+	statement_scratch.resize(first);
+	return arena.make<BlockExpression>(stmts, block->opening_block);
+}
+
+FunctionDeclarationStatement* Monomorphizer::clone_function(FunctionDeclarationStatement* func, const Token& name) {
+	std::vector<std::pair<Type, Token>> params{(func->params | std::views::transform([&](const std::pair<Type, Token>& param) {
+		return std::make_pair(substitute(param.first), param.second);
+	})) | std::ranges::to<std::vector>()};
+	return arena.make<FunctionDeclarationStatement>(
+		substitute(func->return_type),
+		arena.make<IdentifierExpression>(name),
+		std::move(params),
+		clone_block(func->block),
+		func->type_params
+	);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Arena.h"
+#include "Syntax.h"
+#include "Types.h"
+
+// Specializes generic functions. An instance is a copy of the generic's
+// declaration with every type parameter replaced by a type argument, named
+// after both, e.g. `max<i32>`; it is analyzed and generated like any other
+// function, so nothing is boxed or dispatched at run time. Each generic has
+// at most one instance per list of type arguments, however many calls ask.
+class Monomorphizer {
+public:
+	// Copies go into `arena`, which has to outlive them like the rest of the tree.
+	explicit Monomorphizer(Arena& arena) : arena{arena} { }
+
+	// `type` with each of `params` replaced by the matching one of `args`.
+	static Type substitute(Type type, std::span<const Token> params, std::span<const Type> args);
+
+	// The instance of `generic` for `args`, which have to be ground. Sets
+	// `created` if this is the first time these arguments were asked for.
+	FunctionDeclarationStatement* instantiate(FunctionDeclarationStatement* generic, std::span<const Type> args, bool& created);
+
+private:
+	Arena& arena;
+	// By the ids of the type arguments.
+	std::unordered_map<const FunctionDeclarationStatement*, std::map<std::vector<uint32_t>, FunctionDeclarationStatement*>> instances{};
+
+	// The replacements of the copy under way.
+	std::vector<Token> bound_params{};
+	std::vector<Type> bound_args{};
+
+	// Children of the blocks and calls still being copied, as in the Parser.
+	std::vector<Statement*> statement_scratch{};
+	std::vector<Expression*> expression_scratch{};
+
+	Type substitute(Type type) const { return substitute(type, bound_params, bound_args); }
+	Expression* clone(Expression* expr);
+	Statement* clone(Statement* stmt);
+	BlockExpression* clone_block(BlockExpression* block);
+	FunctionDeclarationStatement* clone_function(FunctionDeclarationStatement* func, const Token& name);
+};
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include "ParallelParser.h"
+#include "ErrorHandling.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "Scan.h"
+#include "TokenStream.h"
+
+std::vector<std::string_view> ParallelParser::split(std::string_view source, size_t min_bytes) {
+	std::vector<std::string_view> chunks{};
+	const char* p{source.data()};
+	const char* end{p + source.size()};
+	const char* chunk_start{p};
+	int depth{0};
+
+	auto cut{[&] {
+		if (p - chunk_start < (ptrdiff_t)min_bytes) return;
+		chunks.emplace_back(chunk_start, p - chunk_start);
+		chunk_start = p;
+	}};
+
+	while (p < end) {
+		char c{*p++};
+		switch (c) {
+			case '{':
+				depth++;
+				break;
+			case '}': {
+				if (--depth < 0) return {source};
+				// `i32 x = { ... };` goes on to its ';', which makes the cut.
+				const char* next{scan_kernels().skip_whitespace(p, end)};
+				if (depth == 0 && (next == end || *next != ';')) cut();
+				break;
+			}
+			case ';':
+				if (depth == 0) cut();
+				break;
+			case '"':
+			case '\'':
+				p = find_byte(p, end, c);
+				if (p == end) return {source};
+				p++;
+				break;
+			case '/':
+				if (p < end && *p == '/') p = find_byte(p, end, '\n');
+				break;
+		}
+	}
+
+	if (depth != 0) return {source};
+	chunks.emplace_back(chunk_start, end - chunk_start);
+	return chunks;
+}
+
+std::vector<Statement*> ParallelParser::sequential() {
+	Lexer lexer{source};
+	TokenStream toks{lexer, dump};
+	Parser parser{toks, arena};
+	auto stmts{parser.run()};
+	toks.drain();
+	return stmts;
+}
+
+void ParallelParser::parse_chunk(Chunk& chunk) const {
+	muted_errors = &chunk.errors;
+
+	std::ostringstream chunk_dump{};
+	Lexer lexer{Lexer::for_chunk(chunk.text)};
+	TokenStream toks{lexer, dump != nullptr ? &chunk_dump : nullptr};
+	Parser parser{toks, chunk.arena};
+	chunk.statements = parser.run();
+	toks.drain();
+	chunk.dump = std::move(chunk_dump).str();
+
+	muted_errors = nullptr;
+}
+
+std::vector<Statement*> ParallelParser::run() {
+	if (jobs <= 1) return sequential();
+
+	size_t min_bytes{std::max(source.size() / (jobs * 4), MIN_CHUNK_BYTES)};
+	auto texts{split(source, min_bytes)};
+	if (texts.size() <= 1) return sequential();
+
+	std::vector<Chunk> chunks(texts.size());
+	for (size_t i{0}; i < texts.size(); i++) {
+		chunks[i].text = texts[i];
+	}
+
+	// Workers only read the source and its line index from here on.
+	SourceMap::reset(source);
+	SourceMap::index();
+
+	std::atomic<size_t> next{0};
+	auto work{[&] {
+		for (size_t i{next++}; i < chunks.size(); i = next++) {
+			parse_chunk(chunks[i]);
+		}
+	}};
+	{
+		std::vector<std::jthread> pool{};
+		for (unsigned int i{1}; i < std::min<size_t>(jobs, chunks.size()); i++) {
+			pool.emplace_back(work);
+		}
+		work();
+	}
+
+	if (std::ranges::any_of(chunks, [](const Chunk& chunk) { return chunk.errors != 0; })) {
+		return sequential();
+	}
+
+	std::vector<Statement*> stmts{};
+	for (size_t i{0}; i < chunks.size(); i++) {
+		std::ranges::move(chunks[i].statements, std::back_inserter(stmts));
+		arena.adopt(std::move(chunks[i].arena));
+
+		if (dump == nullptr) continue;
+		// Each chunk's dump ends with its own END_OF_FILE; only the last is real.
+		std::string_view text{chunks[i].dump};
+		if (i + 1 < chunks.size()) {
+			text = text.substr(0, text.rfind('\n', text.size() - 2) + 1);
+		}
+		*dump << text;
+	}
+
+	return stmts;
+}
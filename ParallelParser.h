@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Syntax.h"
+
+// Front end for one large file on several cores. The source is cut at
+// top-level declaration boundaries (a ';' or '}' at brace depth zero,
+// outside comments and literals) and a pool of worker threads lexes and
+// parses the chunks. Tokens keep pointing into the whole source, and the
+// statements and token dump are merged back in source order, so the result
+// matches a single Parser over the whole file.
+//
+// Workers keep their diagnostics muted. If any chunk reports one, the file
+// is parsed again sequentially so the messages come out exactly as usual.
+class ParallelParser {
+public:
+	static constexpr size_t MIN_CHUNK_BYTES{16 * 1024};
+
+	// `jobs` of 1 (or a source too small to split) parses on the calling thread.
+	// Nodes end up in `arena`; each chunk parses into its own and is adopted.
+	ParallelParser(std::string_view source, unsigned int jobs, Arena& arena, std::ostream* dump = nullptr)
+		: source{source}, jobs{jobs}, arena{arena}, dump{dump} { }
+
+	std::vector<Statement*> run();
+
+	// Chunks of at least min_bytes (bar the last) that each start a top-level
+	// declaration. Gives back the whole source if its braces or literals
+	// don't balance; the sequential parser reports those.
+	static std::vector<std::string_view> split(std::string_view source, size_t min_bytes);
+
+private:
+	struct Chunk {
+		std::string_view text{};
+		std::vector<Statement*> statements{};
+		Arena arena{};
+		std::string dump{};
+		unsigned int errors{};
+	};
+
+	std::string_view source{};
+	unsigned int jobs{};
+	Arena& arena;
+	std::ostream* dump{};
+
+	std::vector<Statement*> sequential();
+	void parse_chunk(Chunk& chunk) const;
+};
@@ -1,14 +1,18 @@
+#include <algorithm>
 #include "Parser.h"
 #include "Lexer.h"
 #include "Syntax.h"
+#include "Stack.h"
 #include "Types.h"
 
-std::vector<std::shared_ptr<Statement>> Parser::run() {
-	std::vector<std::shared_ptr<Statement>> statements{};
+std::vector<Statement*> Parser::run() {
+	std::vector<Statement*> statements{};
 	while (!is_at_end()) {
 		try {
-			statements.push_back(statement());
+			if (Statement* stmt{statement()}) statements.push_back(stmt);
 		} catch (const ParserException& e) {
+			statement_scratch.clear();
+			expression_scratch.clear();
 			synchronize();
 			return {};
 		}
@@ -21,8 +25,8 @@ ParserException Parser::parse_error(const Token& tok, const std::string& message
 	return ParserException{tok, message};
 }
 
-Token Parser::peek() {
-	return toks[current];
+const Token& Parser::peek() {
+	return toks.peek();
 }
 
 bool Parser::is_at_end() {
@@ -34,37 +38,30 @@ bool Parser::check(TokenType type) {
 	return (peek().type == type);
 }
 
-Token Parser::previous() {
-	return toks[current-1];
+const Token& Parser::previous() {
+	return toks.previous();
 }
 
-Token Parser::advance() {
-	if (!is_at_end()) current++;
+const Token& Parser::advance() {
+	if (!is_at_end()) toks.advance();
 	return previous();
 }
 
-bool Parser::match(const std::vector<TokenType>& types) {
-	for (TokenType type : types) {
-		if (check(type)) {
-			advance();
-			return true;
-		}
-	}
-
-	return false;
+bool Parser::match(TokenType type) {
+	if (!check(type)) return false;
+	advance();
+	return true;
 }
 
-Token Parser::consume(TokenType type, const std::string& message) {
-	if (check(type)) return advance();
-	throw parse_error(peek(), message);
-	return Token{};
+bool Parser::match(TokenSet types) {
+	if (is_at_end() || !types.contains(peek().type)) return false;
+	advance();
+	return true;
 }
 
-Token Parser::consume(const std::vector<TokenType>& types, const std::string& message) {
-	for (const auto& type : types)
-		if (check(type)) return advance();
-	throw parse_error(peek(), message);
-	return Token{};
+const Token& Parser::consume(TokenType type, std::string_view message) {
+	if (check(type)) return advance();
+	throw parse_error(peek(), std::string{message});
 }
 
 void Parser::synchronize() {
@@ -75,226 +72,200 @@ void Parser::synchronize() {
 	}
 }
 
-std::shared_ptr<Expression> Parser::primary_expression() {
-	if (match({TokenType::IDENTIFIER})) {
-		return std::make_shared<IdentifierExpression>(previous());
+Expression* Parser::primary_expression() {
+	if (match(TokenType::IDENTIFIER)) {
+		return arena.make<IdentifierExpression>(previous());
 	} else if (match(literal_tokens)) {
-		return std::make_shared<LiteralExpression>(previous());
-	} else if (match({TokenType::LEFT_PAREN})) {
-		std::shared_ptr<Expression> expr{expression()};
+		return arena.make<LiteralExpression>(previous());
+	} else if (match(TokenType::LEFT_PAREN)) {
+		Expression* expr{expression()};
 		consume(TokenType::RIGHT_PAREN, "Expected ')' after expression.");
-		return std::make_shared<GroupingExpression>(expr);
+		return arena.make<GroupingExpression>(expr);
 	}
 	throw parse_error(peek(), "Invalid expression.");
 	return nullptr;
 }
 
-std::shared_ptr<Expression> Parser::expression() {
-	if (match({TokenType::LEFT_BRACE})) {
+Expression* Parser::expression() {
+	if (stack_exhausted()) return on_new_stack([&] { return expression(); });
+	if (match(TokenType::LEFT_BRACE)) {
 		return block_expression();
 	} else {
 		return assignment_expression();
 	}
 }
 
-std::shared_ptr<BlockExpression> Parser::block_expression() {
+BlockExpression* Parser::block_expression() {
 	Token opening_block{previous()};
-	std::vector<std::shared_ptr<Statement>> stmts{};
+	size_t first{statement_scratch.size()};
 	while (!is_at_end()) {
-		if (match({TokenType::RIGHT_BRACE})) {
-			return std::make_shared<BlockExpression>(stmts, opening_block);
+		if (match(TokenType::RIGHT_BRACE)) {
+			auto stmts{arena.copy(std::span{statement_scratch}.subspan(first))};
+			statement_scratch.resize(first);
+			return arena.make<BlockExpression>(stmts, opening_block);
 		}
 
-		stmts.push_back(statement());
+		if (Statement* stmt{statement()}) statement_scratch.push_back(stmt);
 	}
 
 	throw parse_error(opening_block, "No closing brace found.");
 	return nullptr;
 }
 
-std::shared_ptr<Expression> Parser::assignment_expression() {
-	auto lhs{conditional_expression()};
-	while (match({TokenType::EQUAL})) {
-		Token op{previous()};
-		auto rhs{assignment_expression()};
-		lhs = std::make_shared<BinaryExpression>(lhs, op, rhs);
-	}
-	return lhs;
-}
-
-std::shared_ptr<Expression> Parser::conditional_expression() {
-	return logical_or_expression();
+Expression* Parser::assignment_expression() {
+	return binary_expression(Precedence::ASSIGNMENT);
 }
 
-std::shared_ptr<Expression> Parser::logical_or_expression() {
-	auto lhs{logical_and_expression()};
-	while (match({TokenType::OR})) {
-		Token op{previous()};
-		auto rhs{logical_and_expression()};
-		lhs = std::make_shared<BinaryExpression>(lhs, op, rhs);
-	}
-
-	return lhs;
-}
-
-std::shared_ptr<Expression> Parser::logical_and_expression() {
-	auto lhs{equality_expression()};
-	while (match({TokenType::AND})) {
-		Token op{previous()};
-		auto rhs{equality_expression()};
-		lhs = std::make_shared<BinaryExpression>(lhs, op, rhs);
-	}
-
-	return lhs;
-}
-
-std::shared_ptr<Expression> Parser::equality_expression() {
-	auto lhs{relational_expression()};
-	while (match({TokenType::EQUAL_EQUAL, TokenType::NOT_EQUAL})) {
-		Token op{previous()};
-		auto rhs{(relational_expression())};
-		lhs = std::make_shared<BinaryExpression>(lhs, op, rhs);
-	}
-
-	return lhs;
-}
-
-std::shared_ptr<Expression> Parser::relational_expression() {
-	auto lhs{additive_expression()};
-	while (match({TokenType::LESS, TokenType::GREATER, TokenType::LESS_EQUAL, TokenType::GREATER_EQUAL})) {
-		Token op{previous()};
-		auto rhs{additive_expression()};
-		lhs = std::make_shared<BinaryExpression>(lhs, op, rhs);
-	}
-
-	return lhs;
-}
-
-std::shared_ptr<Expression> Parser::additive_expression() {
-	auto lhs{multiplicative_expression()};
-	while (match({TokenType::PLUS, TokenType::MINUS})) {
-		Token op{previous()};
-		auto rhs{multiplicative_expression()};
-		lhs = std::make_shared<BinaryExpression>(lhs, op, rhs);
-	}
-
-	return lhs;
-}
-
-std::shared_ptr<Expression> Parser::multiplicative_expression() {
+Expression* Parser::binary_expression(Precedence min_precedence) {
+	if (stack_exhausted()) return on_new_stack([&] { return binary_expression(min_precedence); });
 	auto lhs{cast_expression()};
-	while (match({TokenType::STAR, TokenType::SLASH})) {
-		Token op{previous()};
-		auto rhs{cast_expression()};
-		lhs = std::make_shared<BinaryExpression>(lhs, op, rhs);
+	for (;;) {
+		Precedence precedence{binary_precedence[(size_t)peek().type]};
+		if (precedence == Precedence::NONE || precedence < min_precedence) break;
+
+		Token op{advance()};
+		// Assignment is right-associative; every other level is left-associative.
+		auto rhs{binary_expression(op.type == TokenType::EQUAL ? precedence : (Precedence)((uint8_t)precedence + 1))};
+		lhs = arena.make<BinaryExpression>(lhs, op, rhs);
 	}
 
 	return lhs;
 }
 
-std::shared_ptr<Expression> Parser::cast_expression() {
+Expression* Parser::cast_expression() {
 	auto expr{unary_expression()};
-	if (match({TokenType::AS})) {
-		expr = std::make_shared<CastExpression>(expr, previous(), type());
+	if (match(TokenType::AS)) {
+		Token as{previous()};
+		expr = arena.make<CastExpression>(expr, as, type());
 	}
 	return expr;
 }
 
-std::shared_ptr<Expression> Parser::unary_expression() {
-	while (match({TokenType::NOT, TokenType::MINUS, TokenType::AMPERSAND, TokenType::STAR})) {
+Expression* Parser::unary_expression() {
+	if (stack_exhausted()) return on_new_stack([&] { return unary_expression(); });
+	if (match(unary_operators)) {
 		return prefix_unary_expression();
 	}
 	return postfix_unary_expression();
 }
 
-std::shared_ptr<Expression> Parser::prefix_unary_expression() {
+Expression* Parser::prefix_unary_expression() {
 	Token op{previous()};
 	auto expr{unary_expression()};
-	return std::make_shared<UnaryExpression>(op, expr);
+	return arena.make<UnaryExpression>(op, expr);
 }
 
-std::shared_ptr<Expression> Parser::postfix_unary_expression() {
+Expression* Parser::postfix_unary_expression() {
 	auto expr{return_expression()};
-	while (match({TokenType::LEFT_PAREN})) {
+	while (match(TokenType::LEFT_PAREN)) {
 		auto arg_list{argument_expression_list()};
-		expr = std::make_shared<CallExpression>(expr, previous(), arg_list);
+		expr = arena.make<CallExpression>(expr, previous(), arg_list);
 	}
 
 	return expr;
 }
 
-std::vector<std::shared_ptr<Expression>> Parser::argument_expression_list() {
-	std::vector<std::shared_ptr<Expression>> args{};
+std::span<Expression*> Parser::argument_expression_list() {
+	size_t first{expression_scratch.size()};
 	if (!check(TokenType::RIGHT_PAREN)) {
 		do {
-			if (args.size() >= MAX_ARGS) {
+			if (expression_scratch.size() - first >= MAX_ARGS) {
 				error(peek(), "Cannot have more than 100 arguments.");
 			}
-			args.push_back(assignment_expression());
-		} while (match({TokenType::COMMA}));
+			Expression* arg{assignment_expression()};
+			expression_scratch.push_back(arg);
+		} while (match(TokenType::COMMA));
 	}
 	
 	consume(TokenType::RIGHT_PAREN, "Expected closing parenthesis.");
 
+	auto args{arena.copy(std::span{expression_scratch}.subspan(first))};
+	expression_scratch.resize(first);
 	return args;
 }
 
-std::shared_ptr<Expression> Parser::return_expression() {
-	if (match({TokenType::RETURN})) {
-		return std::make_shared<ReturnExpression>(previous(), expression());
+Expression* Parser::return_expression() {
+	if (match(TokenType::RETURN)) {
+		Token return_tok{previous()};
+		return arena.make<ReturnExpression>(return_tok, expression());
 	}
 
 	return primary_expression();
 }
 
-std::shared_ptr<Statement> Parser::statement() {
-	if (match({TokenType::SEMICOLON})) { return nullptr; }
-	if (match(type_tokens())) {
+Statement* Parser::statement() {
+	if (match(TokenType::SEMICOLON)) { return nullptr; }
+	if (is_type_token(peek().type)) {
+		advance();
 		return declaration(type(true));
 	}
+	// No expression starts with two names, so this declares something of a named type.
+	if (check(TokenType::IDENTIFIER) && toks.peek(1).type == TokenType::IDENTIFIER) {
+		return declaration(type());
+	}
 	return expression_statement();
 }
 
-std::shared_ptr<ExpressionStatement> Parser::expression_statement() {
+ExpressionStatement* Parser::expression_statement() {
 	auto expr{expression()};
 	consume(TokenType::SEMICOLON, "Expected semi-colon after statement.");
-	return std::make_shared<ExpressionStatement>(expr);
+	return arena.make<ExpressionStatement>(expr);
 }
 
-std::shared_ptr<Statement> Parser::declaration(const Type& type) {
+Statement* Parser::declaration(const Type& type) {
 	Token name{consume(TokenType::IDENTIFIER, "Expected identifier.")};
 	
-	if (match({TokenType::EQUAL})) {
+	if (match(TokenType::EQUAL)) {
 		return variable_declaration(type, name);
-	} else if (match({TokenType::LEFT_PAREN})) {
+	} else if (match(TokenType::LEFT_PAREN)) {
 		return function_declaration(type, name);
+	} else if (match(TokenType::LESS)) {
+		auto type_params{type_parameters()};
+		consume(TokenType::LEFT_PAREN, "Expected parameter list after type parameters.");
+		return function_declaration(type, name, std::move(type_params));
 	} else {
 		throw parse_error(advance(), "Unexpected token.");
 		return nullptr;
 	}
 }
 
-std::shared_ptr<VariableDeclarationStatement> Parser::variable_declaration(const Type& type, const Token& name) {
+VariableDeclarationStatement* Parser::variable_declaration(const Type& type, const Token& name) {
 	auto initializer{expression()};
 	consume(TokenType::SEMICOLON, "Expected semi-colon after variable declaration statement.");
-	return std::make_shared<VariableDeclarationStatement>(
+	return arena.make<VariableDeclarationStatement>(
 		type,
-		std::make_shared<IdentifierExpression>(name),
+		arena.make<IdentifierExpression>(name),
 		initializer
 	);
 }
 
-std::shared_ptr<FunctionDeclarationStatement> Parser::function_declaration(const Type& type, const Token& name) {
+FunctionDeclarationStatement* Parser::function_declaration(const Type& type, const Token& name, std::vector<Token> type_params) {
 	auto params{parameters()};
 	consume(TokenType::LEFT_BRACE, "Expected left brace.");
-	return std::make_shared<FunctionDeclarationStatement>(
+	return arena.make<FunctionDeclarationStatement>(
 		type,
-		std::make_shared<IdentifierExpression>(name),
-		params,
-		block_expression()
+		arena.make<IdentifierExpression>(name),
+		std::move(params),
+		block_expression(),
+		std::move(type_params)
 	);
 }
 
+std::vector<Token> Parser::type_parameters() {
+	std::vector<Token> type_params{};
+	do {
+		Token param{consume(TokenType::IDENTIFIER, "Expected type parameter name.")};
+		if (std::ranges::any_of(type_params, [&](const Token& other) { return other.symbol == param.symbol; })) {
+			error(param, "Type parameter already declared.");
+		}
+		type_params.push_back(param);
+	} while (match(TokenType::COMMA));
+
+	consume(TokenType::GREATER, "Expected '>' after type parameters.");
+
+	return type_params;
+}
+
 std::vector<std::pair<Type, Token>> Parser::parameters() {
 	std::vector<std::pair<Type, Token>> params{};
 	if (!check(TokenType::RIGHT_PAREN)) {
@@ -305,7 +276,7 @@ std::vector<std::pair<Type, Token>> Parser::parameters() {
 			Type param_type{type()};
 			Token name{consume(TokenType::IDENTIFIER, "Expected identifier.")};
 			params.push_back(std::make_pair(param_type, name));
-		} while (match({TokenType::COMMA}));
+		} while (match(TokenType::COMMA));
 	}
 
 	consume(TokenType::RIGHT_PAREN, "Expected closing parenthesis.");
@@ -317,19 +288,23 @@ Type Parser::type(bool get_previous) {
 	Type ret{};
 	if (get_previous) {
 		if (auto t{token_to_type(previous())}) {
-			ret = std::make_shared<TConstructor>(t.value());
+			ret = Type::constructor(t.value());
 		} else {
 			ret = nullptr;
 		}
+	} else if (match(TokenType::IDENTIFIER)) {
+		// Analysis reports a name that is no type parameter in scope.
+		ret = Type::parameter(previous().symbol);
 	} else {
-		if (auto t{token_to_type(consume(type_tokens(), "Expected a type specifier."))})
-			ret = std::make_shared<TConstructor>(t.value());
+		if (!is_type_token(peek().type)) throw parse_error(peek(), "Expected a type specifier.");
+		if (auto t{token_to_type(advance())})
+			ret = Type::constructor(t.value());
 		else
 			ret = nullptr;
 	}
 
-	while (match({TokenType::STAR})) {
-		ret = std::make_shared<TPointer>(ret);
+	while (match(TokenType::STAR)) {
+		ret = Type::pointer_to(ret);
 	}
 
 	return ret;
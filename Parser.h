@@ -2,6 +2,7 @@
 
 #include <exception>
 #include "Syntax.h"
+#include "TokenStream.h"
 #include "ErrorHandling.h"
 
 class ParserException : public std::runtime_error {
@@ -14,53 +15,84 @@ private:
 	Token tok{};
 };
 
+// Binding strength of the binary operators, lowest first. NONE marks
+// tokens that do not continue a binary expression.
+enum class Precedence : uint8_t {
+	NONE, ASSIGNMENT, LOGICAL_OR, LOGICAL_AND, EQUALITY, RELATIONAL, ADDITIVE, MULTIPLICATIVE
+};
+
+inline constexpr auto binary_precedence{[] {
+	std::array<Precedence, (size_t)TokenType::END_OF_FILE + 1> table{};
+	table[(size_t)TokenType::EQUAL] = Precedence::ASSIGNMENT;
+	table[(size_t)TokenType::OR] = Precedence::LOGICAL_OR;
+	table[(size_t)TokenType::AND] = Precedence::LOGICAL_AND;
+	table[(size_t)TokenType::EQUAL_EQUAL] = Precedence::EQUALITY;
+	table[(size_t)TokenType::NOT_EQUAL] = Precedence::EQUALITY;
+	table[(size_t)TokenType::LESS] = Precedence::RELATIONAL;
+	table[(size_t)TokenType::GREATER] = Precedence::RELATIONAL;
+	table[(size_t)TokenType::LESS_EQUAL] = Precedence::RELATIONAL;
+	table[(size_t)TokenType::GREATER_EQUAL] = Precedence::RELATIONAL;
+	table[(size_t)TokenType::PLUS] = Precedence::ADDITIVE;
+	table[(size_t)TokenType::MINUS] = Precedence::ADDITIVE;
+	table[(size_t)TokenType::STAR] = Precedence::MULTIPLICATIVE;
+	table[(size_t)TokenType::SLASH] = Precedence::MULTIPLICATIVE;
+	return table;
+}()};
+
+inline constexpr TokenSet unary_operators{
+	TokenType::NOT, TokenType::MINUS, TokenType::AMPERSAND, TokenType::STAR
+};
+
 class Parser {
 public:
-	Parser(const std::vector<Token>& toks) : toks{toks} { }
+	// Nodes are allocated in `arena`, which has to outlive the returned tree.
+	Parser(TokenStream& toks, Arena& arena) : toks{toks}, arena{arena} { }
 
-	std::vector<std::shared_ptr<Statement>> run();
+	std::vector<Statement*> run();
 
 private:
-	std::vector<Token> toks;
-	int current{};
+	TokenStream& toks;
+	Arena& arena;
+
+	// Children of the blocks and calls still being parsed, stacked so that
+	// nested lists share one buffer; each list is copied into the arena
+	// once it is complete.
+	std::vector<Statement*> statement_scratch{};
+	std::vector<Expression*> expression_scratch{};
 
 	static constexpr uint8_t MAX_ARGS{100};
 
 	ParserException parse_error(const Token& tok, const std::string& message) const noexcept;
 
-	Token peek();
+	const Token& peek();
 	bool is_at_end();
 	bool check(TokenType type);
-	Token previous();
-	Token advance();
-	bool match(const std::vector<TokenType>& types);
-	Token consume(TokenType type, const std::string& message);
-	Token consume(const std::vector<TokenType>& types, const std::string& message);
+	const Token& previous();
+	const Token& advance();
+	bool match(TokenType type);
+	bool match(TokenSet types);
+	const Token& consume(TokenType type, std::string_view message);
 
 	void synchronize();
 	
-	std::shared_ptr<Expression> primary_expression();
-	std::shared_ptr<Expression> expression();
-	std::shared_ptr<BlockExpression> block_expression();
-	std::shared_ptr<Expression> assignment_expression();
-	std::shared_ptr<Expression> conditional_expression();
-	std::shared_ptr<Expression> logical_or_expression();
-	std::shared_ptr<Expression> logical_and_expression();
-	std::shared_ptr<Expression> equality_expression();
-	std::shared_ptr<Expression> relational_expression();
-	std::shared_ptr<Expression> additive_expression();
-	std::shared_ptr<Expression> multiplicative_expression();
-	std::shared_ptr<Expression> cast_expression();
-	std::shared_ptr<Expression> unary_expression();
-	std::shared_ptr<Expression> prefix_unary_expression();
-	std::shared_ptr<Expression> postfix_unary_expression();
-	std::vector<std::shared_ptr<Expression>> argument_expression_list();
-	std::shared_ptr<Expression> return_expression();
-	std::shared_ptr<Statement> statement();
-	std::shared_ptr<ExpressionStatement> expression_statement();
-	std::shared_ptr<Statement> declaration(const Type& type);
-	std::shared_ptr<VariableDeclarationStatement> variable_declaration(const Type& type, const Token& name);
-	std::shared_ptr<FunctionDeclarationStatement> function_declaration(const Type& type, const Token& name);
+	Expression* primary_expression();
+	Expression* expression();
+	BlockExpression* block_expression();
+	Expression* assignment_expression();
+	Expression* binary_expression(Precedence min_precedence);
+	Expression* cast_expression();
+	Expression* unary_expression();
+	Expression* prefix_unary_expression();
+	Expression* postfix_unary_expression();
+	std::span<Expression*> argument_expression_list();
+	Expression* return_expression();
+	// Null for an empty statement, which callers leave out of the tree.
+	Statement* statement();
+	ExpressionStatement* expression_statement();
+	Statement* declaration(const Type& type);
+	VariableDeclarationStatement* variable_declaration(const Type& type, const Token& name);
+	FunctionDeclarationStatement* function_declaration(const Type& type, const Token& name, std::vector<Token> type_params = {});
+	std::vector<Token> type_parameters();
 	std::vector<std::pair<Type, Token>> parameters();
 	Type type(bool get_previous = false);
 };
@@ -1,95 +1,73 @@
-#include <sstream>
+#include <iterator>
 #include <ostream>
 #include "ROC.h"
-#include "Parser.h"
-#include "TypeAnalyzer.h"
-#include "EnvironmentAnalyzer.h"
+#include "ParallelParser.h"
+#include "SemanticAnalyzer.h"
+#include "SSABuilder.h"
+#include "SSAOptimizer.h"
 #include "IntermediateCodeGenerator.h"
 #include "ASCodeGenerator.h"
 
 void ROC::run(const std::string& line) {
-	Lexer lexer{line};
-	auto toks{lexer.run()};
-
-	std::cout << "Lexing completed.\n";
-
-	Parser parser{toks};
-	auto stmts{parser.run()};
-
-	std::cout << "Parsing completed.\n";
-
-	TypeAnalyzer ta{stmts};
-	if (ta.run()) return;
-
-	EnvironmentAnalyzer ea{stmts};
-	if (!ea.run()) return;
-
-	std::cout << "Environment analysis completed.\n";
-
-	IntermediateCodeGenerator icg{stmts};
-	auto cmds{icg.run()};
-
-	std::cout << "Intermediate code generation completed.\n";
-
-	ASCodeGenerator as{cmds};
-	auto as_cmds{as.run()};
-
-	std::cout << "GAS code generation completed.\n";
-
-	std::ofstream out{"rocout.s"};
-	for (auto cmd : as_cmds) {
-		out << cmd << '\n';
-	}
-	out.close();
+	CompilationUnit unit{std::string_view{line}};
+	compile(unit);
 }
 
 void ROC::run(const std::ifstream& file) {
-	std::stringstream ss{};
-	ss << file.rdbuf();
-	Lexer lexer{ss.str()};
-	auto toks{lexer.run()};
-
-	std::cout << "Lexing completed.\n";
+	CompilationUnit unit{std::string{std::istreambuf_iterator<char>{file.rdbuf()}, {}}};
+	compile(unit);
+}
 
-	std::ofstream lex_out{"rocout.lex"};
-	for (auto tok : toks) {
-		lex_out << tok << '\n';
+void ROC::run(const SourceFile& file) {
+	if (!file.is_open()) {
+		std::cerr << "Unable to read source file." << std::endl;
+		return;
 	}
+	CompilationUnit unit{file.view()};
+	compile(unit);
+}
 
-	Parser parser{toks};
-	auto stmts{parser.run()};
+void ROC::compile(CompilationUnit& unit) {
+	std::ofstream lex_out{"rocout.lex"};
+	unit.statements = ParallelParser{unit.source, jobs, unit.arena, &lex_out}.run();
+	lex_out.close();
 
+	std::cout << "Lexing completed.\n";
 	std::cout << "Parsing completed.\n";
 	
-	TypeAnalyzer ta{stmts};
-	if (!ta.run()) return;
+	SemanticAnalyzer analyzer{unit.statements, unit.arena};
+	if (!analyzer.infer()) return;
 
 	std::cout << "Type analysis completed.\n";
 
-	EnvironmentAnalyzer ea{stmts};
-	if (!ea.run()) return;
+	if (!analyzer.check()) return;
+	unit.statements = analyzer.program();
 
 	std::cout << "Environment analysis completed.\n";
 
-	IntermediateCodeGenerator icg{stmts};
-	auto cmds{icg.run()};
-
-	std::cout << "Intermediate code generation completed.\n";
+	unit.ssa = SSABuilder{unit.statements}.run();
+	unit.release_ast();
+	SSAOptimizer{unit.ssa}.run();
 
+	// The SSA, then the commands it is lowered to.
 	std::ofstream ir_out{"rocout.ir"};
-	for (auto cmd : cmds) {
-		ir_out << cmd << '\n';
-	}
+	ir_out << unit.ssa;
 
-	ASCodeGenerator as{cmds};
-	auto as_cmds{as.run()};
+	unit.ir = IntermediateCodeGenerator{unit.ssa}.run();
+	unit.release_ssa();
+	ir_out << '\n' << unit.ir;
+	ir_out.close();
+
+	std::cout << "Intermediate code generation completed.\n";
+
+	unit.assembly = ASCodeGenerator{unit.ir}.run();
+	unit.release_ir();
 
 	std::cout << "GAS code generation completed.\n";
 
 	std::ofstream out{"rocout.s"};
-	for (auto cmd : as_cmds) {
+	for (const auto& cmd : unit.assembly) {
 		out << cmd << '\n';
 	}
 	out.close();
 }
-
@@ -1,11 +1,23 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <fstream>
+#include "Source.h"
+#include "CompilationUnit.h"
 
 class ROC {
 public:
+	// Threads used to lex and parse one file (see ParallelParser).
+	explicit ROC(unsigned int jobs = 1) : jobs{jobs} { }
+
 	void run(const std::string& line);
 	void run(const std::ifstream& file);
+	void run(const SourceFile& file);
+
+private:
+	unsigned int jobs{1};
+
+	void compile(CompilationUnit& unit);
 };
 
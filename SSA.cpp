@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <ranges>
+#include "SSA.h"
+
+std::span<const BlockId> SSAFunction::successors(BlockId block) const {
+	const Instruction& last{blocks[block].instructions.back()};
+	switch (last.op) {
+		case Opcode::JUMP: return {last.targets.data(), 1};
+		case Opcode::BRANCH: return last.targets;
+		default: return {};
+	}
+}
+
+std::vector<BlockId> SSAFunction::reverse_postorder() const {
+	std::vector<BlockId> order{};
+	std::vector<bool> visited(blocks.size());
+	// Each block with the number of its successors already followed.
+	std::vector<std::pair<BlockId, size_t>> path{{0, 0}};
+	visited[0] = true;
+	while (!path.empty()) {
+		auto& [block, next]{path.back()};
+		std::span<const BlockId> succs{successors(block)};
+		if (next == succs.size()) {
+			order.push_back(block);
+			path.pop_back();
+			continue;
+		}
+		BlockId succ{succs[next++]};
+		if (!visited[succ]) {
+			visited[succ] = true;
+			path.emplace_back(succ, 0);
+		}
+	}
+	std::ranges::reverse(order);
+	return order;
+}
+
+std::vector<BlockId> SSAFunction::dominators() const {
+	std::vector<BlockId> order{reverse_postorder()};
+	std::vector<uint32_t> position(blocks.size(), NO_ID);
+	for (uint32_t i{0}; i < order.size(); i++) position[order[i]] = i;
+
+	std::vector<BlockId> idom(blocks.size(), NO_ID);
+	idom[0] = 0;
+	auto intersect{[&](BlockId a, BlockId b) {
+		while (a != b) {
+			while (position[a] > position[b]) a = idom[a];
+			while (position[b] > position[a]) b = idom[b];
+		}
+		return a;
+	}};
+
+	bool changed{true};
+	while (changed) {
+		changed = false;
+		for (BlockId block : order | std::views::drop(1)) {
+			BlockId dom{NO_ID};
+			for (BlockId pred : blocks[block].predecessors) {
+				if (idom[pred] == NO_ID) continue;
+				dom = (dom == NO_ID ? pred : intersect(pred, dom));
+			}
+			if (dom != idom[block]) {
+				idom[block] = dom;
+				changed = true;
+			}
+		}
+	}
+	return idom;
+}
+
+uint32_t SSAModule::symbol(std::string_view name) {
+	auto [it, inserted]{symbol_ids.try_emplace(std::string{name}, (uint32_t)symbols.size())};
+	if (inserted) symbols.emplace_back(name);
+	return it->second;
+}
+
+static void print_instruction(std::ostream& os, const SSAModule& module, const Instruction& inst, const BasicBlock& block) {
+	static constexpr const char* names[]{
+		"const", "param", "string", "slot", "global", "load", "store",
+		"add", "sub", "mul", "div", "neg", "not",
+		"eq", "ne", "lt", "le", "gt", "ge",
+		"cast", "call", "phi", "jump", "br", "ret",
+	};
+
+	os << '\t';
+	if (inst.result != NO_ID) os << '%' << inst.result << " = ";
+	os << names[(size_t)inst.op];
+	if (inst.type != nullptr) os << ' ' << type_name(inst.type);
+
+	switch (inst.op) {
+		case Opcode::CONSTANT:
+			os << ' ' << (inst.type->is_signed() ? std::to_string((int64_t)inst.imm) : std::to_string(inst.imm));
+			break;
+		case Opcode::PARAMETER:
+		case Opcode::STRING:
+		case Opcode::SLOT:
+			os << ' ' << inst.imm;
+			break;
+		case Opcode::GLOBAL:
+			os << " @" << module.globals[inst.imm].name;
+			break;
+		case Opcode::CALL:
+			os << " @" << module.symbols[inst.imm];
+			break;
+		default:
+			break;
+	}
+
+	for (size_t i{0}; i < inst.operands.size(); i++) {
+		os << (i == 0 ? " " : ", ") << '%' << inst.operands[i];
+		if (inst.op == Opcode::PHI) os << " .." << block.predecessors[i];
+	}
+	if (inst.targets[0] != NO_ID) os << (inst.operands.empty() ? " ." : ", .") << inst.targets[0];
+	if (inst.targets[1] != NO_ID) os << ", ." << inst.targets[1];
+	os << '\n';
+}
+
+std::ostream& operator<<(std::ostream& os, const SSAModule& module) {
+	for (size_t i{0}; i < module.strings.size(); i++) {
+		os << "string " << i << " \"" << module.strings[i] << "\"\n";
+	}
+	for (const SSAGlobal& global : module.globals) {
+		os << "global @" << global.name << ' ' << type_name(global.type) << " = "
+			<< (global.type->is_signed() ? std::to_string((int64_t)global.init) : std::to_string(global.init)) << '\n';
+	}
+
+	for (const SSAFunction& func : module.functions) {
+		os << "\nfunction @" << func.name << ' ' << type_name(func.return_type) << " (";
+		for (size_t i{0}; i < func.params.size(); i++) {
+			os << (i == 0 ? "" : ", ") << type_name(func.params[i]);
+		}
+		os << ")\n";
+		for (BlockId b{0}; b < func.blocks.size(); b++) {
+			os << '.' << b << ':';
+			for (BlockId pred : func.blocks[b].predecessors) os << " .." << pred;
+			os << '\n';
+			for (const Instruction& inst : func.blocks[b].instructions) print_instruction(os, module, inst, func.blocks[b]);
+		}
+	}
+	return os;
+}
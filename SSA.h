@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Syntax.h"
+#include "Types.h"
+
+// A target-independent form of the program between the tree and x86-64:
+// each function is a control-flow graph of basic blocks over an unlimited
+// supply of values, each defined once, with phis where control flow joins.
+// Memory is only reached through LOAD, STORE and calls, so every other
+// instruction depends on its operands and nothing else.
+
+using ValueId = uint32_t;
+using BlockId = uint32_t;
+
+// No value, or no block.
+constexpr uint32_t NO_ID{UINT32_MAX};
+
+enum class Opcode : uint8_t {
+	// `imm` holds the bits, as Constant does.
+	CONSTANT,
+	// The `imm`th parameter.
+	PARAMETER,
+	// The address of the module's `imm`th string, of the function's `imm`th
+	// slot or of the module's `imm`th global.
+	STRING,
+	SLOT,
+	GLOBAL,
+	// LOAD reads its type from its operand's address; STORE writes its
+	// second operand to its first.
+	LOAD,
+	STORE,
+	ADD,
+	SUB,
+	MUL,
+	DIV,
+	NEG,
+	NOT,
+	// Compare two operands of the same type, giving a bool.
+	EQUAL,
+	NOT_EQUAL,
+	LESS,
+	LESS_EQUAL,
+	GREATER,
+	GREATER_EQUAL,
+	// Widens by the operand's signedness, narrows by wrapping.
+	CAST,
+	// Calls the module's `imm`th symbol with the operands.
+	CALL,
+	// One operand per predecessor, in the same order.
+	PHI,
+	// Terminators, one at the end of every block. BRANCH goes to its first
+	// target if its operand is true and to its second otherwise.
+	JUMP,
+	BRANCH,
+	RETURN,
+};
+
+struct Instruction {
+	Opcode op{};
+	// Of the result; no type if there is none.
+	Type type{};
+	ValueId result{NO_ID};
+	std::vector<ValueId> operands{};
+	uint64_t imm{};
+	std::array<BlockId, 2> targets{NO_ID, NO_ID};
+	// What a CALL may do, which decides whether it can be merged or removed.
+	Effect effect{Effect::EFFECTFUL};
+
+	bool is_terminator() const noexcept { return op >= Opcode::JUMP; }
+};
+
+struct BasicBlock {
+	// Phis first, then the body, then one terminator.
+	std::vector<Instruction> instructions{};
+	std::vector<BlockId> predecessors{};
+};
+
+struct SSAFunction {
+	std::string name{};
+	Type return_type{};
+	std::vector<Type> params{};
+	// The entry block is the first.
+	std::vector<BasicBlock> blocks{};
+	// The type of each value, by id.
+	std::vector<Type> values{};
+	// Memory of the function's own, for variables that are pointed to.
+	std::vector<Type> slots{};
+
+	ValueId new_value(Type type) {
+		values.push_back(type);
+		return (ValueId)(values.size() - 1);
+	}
+
+	std::span<const BlockId> successors(BlockId block) const;
+	// Every block reachable from the entry, each before its successors
+	// unless a back edge leads there.
+	std::vector<BlockId> reverse_postorder() const;
+	// The immediate dominator of each reachable block, by Cooper, Harvey
+	// and Kennedy's iteration; the entry's is itself and an unreachable
+	// block's is NO_ID.
+	std::vector<BlockId> dominators() const;
+};
+
+// A variable declared outside any function, set to a constant before the
+// program starts.
+struct SSAGlobal {
+	std::string name{};
+	Type type{};
+	uint64_t init{};
+};
+
+struct SSAModule {
+	std::vector<SSAFunction> functions{};
+	std::vector<std::string> strings{};
+	std::vector<SSAGlobal> globals{};
+	// Names of the functions that are called, defined here or not.
+	std::vector<std::string> symbols{};
+
+	uint32_t symbol(std::string_view name);
+
+	friend std::ostream& operator<<(std::ostream& os, const SSAModule& module);
+
+private:
+	std::unordered_map<std::string, uint32_t> symbol_ids{};
+};
@@ -0,0 +1,379 @@
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include "SSABuilder.h"
+#include "Stack.h"
+
+SSAModule SSABuilder::run() {
+	for (Statement* stmt : stmts) {
+		generate_statement(stmt);
+	}
+	return std::move(module);
+}
+
+// Itanium's codes for the builtin types.
+std::string SSABuilder::mangle_type(const Type& t) {
+	if (auto ptr{type_cast<TPointer>(t)}) return "P" + mangle_type(ptr->inner);
+	if (auto cons{type_cast<TConstructor>(t)}) {
+		static constexpr const char* codes[]{"a", "s", "i", "l", "h", "t", "j", "m", "b", "v"};
+		int8_t index{token_type_index[(size_t)cons->type.keyword.second]};
+		if (index >= 0) return codes[index];
+	}
+	return "";
+}
+
+std::string SSABuilder::mangle_function(FunctionDeclarationStatement* func) {
+	std::string name{"_Z"};
+	auto source_name{[](Symbol symbol) {
+		std::string_view text{symbol_name(symbol)};
+		return std::to_string(text.size()) + std::string{text};
+	}};
+
+	// An instance is named for its generic and its type arguments.
+	if (func->generic != nullptr) {
+		name += source_name(func->generic->identifier->identifier.symbol) + "I";
+		for (const Type& arg : func->type_args) name += mangle_type(arg);
+		return name + "E";
+	}
+
+	if (env_stack.empty()) return name + source_name(func->identifier->identifier.symbol);
+	name += "N";
+	for (std::stack<Symbol> scopes{env_stack}; !scopes.empty(); scopes.pop()) {
+		name += source_name(scopes.top());
+	}
+	return name + source_name(func->identifier->identifier.symbol) + "E";
+}
+
+BlockId SSABuilder::new_block() {
+	state->func.blocks.emplace_back();
+	state->definitions.emplace_back();
+	state->phis.emplace_back();
+	return (BlockId)(state->func.blocks.size() - 1);
+}
+
+void SSABuilder::add_edge(BlockId from, BlockId to) {
+	state->func.blocks[to].predecessors.push_back(from);
+}
+
+ValueId SSABuilder::emit(Opcode op, Type type, std::vector<ValueId> operands, uint64_t imm) {
+	if (type == Type::of(TypeEnum::NONE)) type = nullptr;
+	ValueId result{type != nullptr ? state->func.new_value(type) : NO_ID};
+	state->func.blocks[state->block].instructions.push_back({op, type, result, std::move(operands), imm});
+	return result;
+}
+
+void SSABuilder::terminate(Opcode op, std::vector<ValueId> operands, BlockId if_true, BlockId if_false) {
+	state->func.blocks[state->block].instructions.push_back({op, nullptr, NO_ID, std::move(operands), 0, {if_true, if_false}});
+	if (if_true != NO_ID) add_edge(state->block, if_true);
+	if (if_false != NO_ID) add_edge(state->block, if_false);
+}
+
+void SSABuilder::write_variable(uint32_t variable, BlockId block, ValueId value) {
+	state->definitions[block][variable] = value;
+}
+
+ValueId SSABuilder::read_variable(uint32_t variable, Type type, BlockId block) {
+	if (auto it{state->definitions[block].find(variable)}; it != state->definitions[block].end()) return it->second;
+	return read_variable_recursive(variable, type, block);
+}
+
+// Every block is made once all of its predecessors are, as there are no
+// loops, so each of them already has its value and a phi is only made when
+// they differ.
+ValueId SSABuilder::read_variable_recursive(uint32_t variable, Type type, BlockId block) {
+	if (stack_exhausted()) return on_new_stack([&] { return read_variable_recursive(variable, type, block); });
+	const std::vector<BlockId>& preds{state->func.blocks[block].predecessors};
+
+	ValueId value{};
+	if (preds.empty()) {
+		// Only unreachable code reads a variable nothing has set. It reads
+		// zero; the block has no phis to come before.
+		value = state->func.new_value(type);
+		state->phis[block].push_back({Opcode::CONSTANT, type, value});
+	} else if (preds.size() == 1) {
+		value = read_variable(variable, type, preds[0]);
+	} else {
+		std::vector<ValueId> operands{};
+		for (BlockId pred : preds) operands.push_back(read_variable(variable, type, pred));
+		if (std::ranges::all_of(operands, [&](ValueId v) { return v == operands[0]; })) {
+			value = operands[0];
+		} else {
+			value = state->func.new_value(type);
+			state->phis[block].push_back({Opcode::PHI, type, value, std::move(operands)});
+		}
+	}
+	write_variable(variable, block, value);
+	return value;
+}
+
+std::optional<ValueId> SSABuilder::address_of(uint32_t variable, Type type) {
+	if (auto global{global_of.find(variable)}; global != global_of.end()) {
+		return emit(Opcode::GLOBAL, Type::pointer_to(type), {}, global->second);
+	}
+	if (auto slot{state->slot_of.find(variable)}; slot != state->slot_of.end()) {
+		return emit(Opcode::SLOT, Type::pointer_to(type), {}, slot->second);
+	}
+	return std::nullopt;
+}
+
+ValueId SSABuilder::address_of(Expression* expr) {
+	while (auto group{node_cast<GroupingExpression>(expr)}) expr = group->expr;
+	if (auto id{node_cast<IdentifierExpression>(expr)}) {
+		auto var{constants.variable(id)};
+		if (auto address{var ? address_of(*var, id->type) : std::nullopt}) return *address;
+	}
+	if (auto un{node_cast<UnaryExpression>(expr)}; un != nullptr && un->op.type == TokenType::STAR) {
+		return generate_expression(un->expr);
+	}
+
+	// Anything else is put somewhere to point to.
+	ValueId value{generate_expression(expr)};
+	uint32_t slot{(uint32_t)state->func.slots.size()};
+	state->func.slots.push_back(expr->type);
+	ValueId address{emit(Opcode::SLOT, Type::pointer_to(expr->type), {}, slot)};
+	emit(Opcode::STORE, nullptr, {address, value});
+	return address;
+}
+
+ValueId SSABuilder::read(uint32_t variable, Type type) {
+	if (auto address{address_of(variable, type)}) return emit(Opcode::LOAD, type, {*address});
+	return read_variable(variable, type, state->block);
+}
+
+void SSABuilder::assign(Expression* target, ValueId value) {
+	while (auto group{node_cast<GroupingExpression>(target)}) target = group->expr;
+	if (auto id{node_cast<IdentifierExpression>(target)}) {
+		auto var{constants.variable(id)};
+		if (!var) return;
+		if (auto address{address_of(*var, id->type)}) {
+			emit(Opcode::STORE, nullptr, {*address, value});
+		} else {
+			write_variable(*var, state->block, value);
+		}
+	} else if (auto un{node_cast<UnaryExpression>(target)}; un != nullptr && un->op.type == TokenType::STAR) {
+		emit(Opcode::STORE, nullptr, {generate_expression(un->expr), value});
+	}
+}
+
+ValueId SSABuilder::generate_expression(Expression* expr) {
+	if (stack_exhausted()) return on_new_stack([&] { return generate_expression(expr); });
+	if (auto value{constants.fold(expr)}) {
+		if (value->type == Type::of(TypeEnum::NONE)) return NO_ID;
+		return constant(expr->type, value->bits);
+	}
+	return visit(expr, overloaded{
+		[&](IdentifierExpression* id) {
+			auto var{constants.variable(id)};
+			return (var ? read(*var, id->type) : NO_ID);
+		},
+		[&](LiteralExpression* lit) {
+			// Everything else folds, unless it is malformed.
+			if (lit->value.type != TokenType::STRING_LITERAL) return constant(lit->type, 0);
+			module.strings.emplace_back(lit->value.text());
+			return emit(Opcode::STRING, lit->type, {}, module.strings.size() - 1);
+		},
+		[&](GroupingExpression* group) { return generate_expression(group->expr); },
+		[&](UnaryExpression* unary) { return unary_expression(unary); },
+		[&](BinaryExpression* binary) { return binary_expression(binary); },
+		[&](BlockExpression* block) { return block_expression(block); },
+		[&](CallExpression* call) { return call_expression(call); },
+		// Only a return among a block's statements leaves anything.
+		[&](ReturnExpression* ret) {
+			return (ret->return_expression != nullptr ? generate_expression(ret->return_expression) : NO_ID);
+		},
+		[&](CastExpression* cast) {
+			ValueId value{generate_expression(cast->expr)};
+			if (value == NO_ID || state->func.values[value] == cast->type) return value;
+			return emit(Opcode::CAST, cast->type, {value});
+		},
+	});
+}
+
+ValueId SSABuilder::unary_expression(UnaryExpression* expr) {
+	if (expr->op.type == TokenType::AMPERSAND) return address_of(expr->expr);
+
+	ValueId value{generate_expression(expr->expr)};
+	switch (expr->op.type) {
+		case TokenType::STAR:
+			return emit(Opcode::LOAD, expr->type, {value});
+		case TokenType::NOT:
+			return emit(Opcode::NOT, expr->type, {value});
+		case TokenType::MINUS:
+			return emit(Opcode::NEG, expr->type, {value});
+		default:
+			return value;
+	}
+}
+
+ValueId SSABuilder::binary_expression(BinaryExpression* expr) {
+	if (expr->op.type == TokenType::EQUAL) {
+		ValueId value{generate_expression(expr->sides.second)};
+		assign(expr->sides.first, value);
+		return value;
+	}
+	if (expr->op.type == TokenType::AND || expr->op.type == TokenType::OR) return short_circuit(expr);
+
+	ValueId lhs{generate_expression(expr->sides.first)};
+	ValueId rhs{generate_expression(expr->sides.second)};
+	Opcode op{};
+	switch (expr->op.type) {
+		case TokenType::PLUS: op = Opcode::ADD; break;
+		case TokenType::MINUS: op = Opcode::SUB; break;
+		case TokenType::STAR: op = Opcode::MUL; break;
+		case TokenType::SLASH: op = Opcode::DIV; break;
+		case TokenType::EQUAL_EQUAL: op = Opcode::EQUAL; break;
+		case TokenType::NOT_EQUAL: op = Opcode::NOT_EQUAL; break;
+		case TokenType::LESS: op = Opcode::LESS; break;
+		case TokenType::LESS_EQUAL: op = Opcode::LESS_EQUAL; break;
+		case TokenType::GREATER: op = Opcode::GREATER; break;
+		case TokenType::GREATER_EQUAL: op = Opcode::GREATER_EQUAL; break;
+		default: return lhs;
+	}
+	return emit(op, expr->type, {lhs, rhs});
+}
+
+// The right side only runs when the left does not settle the result, so
+// the two meet in a block of their own with a phi for the value.
+ValueId SSABuilder::short_circuit(BinaryExpression* expr) {
+	bool is_and{expr->op.type == TokenType::AND};
+	ValueId lhs{generate_expression(expr->sides.first)};
+	ValueId settled{constant(expr->type, is_and ? 0 : 1)};
+
+	BlockId rhs_block{new_block()};
+	BlockId join{new_block()};
+	if (is_and) terminate(Opcode::BRANCH, {lhs}, rhs_block, join);
+	else terminate(Opcode::BRANCH, {lhs}, join, rhs_block);
+
+	state->block = rhs_block;
+	ValueId rhs{generate_expression(expr->sides.second)};
+	terminate(Opcode::JUMP, {}, join);
+
+	state->block = join;
+	ValueId result{state->func.new_value(expr->type)};
+	state->phis[join].push_back({Opcode::PHI, expr->type, result, {settled, rhs}});
+	return result;
+}
+
+// A nested block's value is that of its last return, which ends nothing.
+ValueId SSABuilder::block_expression(BlockExpression* expr) {
+	env_stack.push(intern("_" + std::to_string(block_index++)));
+	ValueId value{NO_ID};
+	for (Statement* stmt : expr->statements) {
+		if (auto expr_stmt{node_cast<ExpressionStatement>(stmt)}) {
+			if (auto ret{node_cast<ReturnExpression>(expr_stmt->expr)}) {
+				value = generate_expression(ret);
+				continue;
+			}
+		}
+		generate_statement(stmt);
+	}
+	env_stack.pop();
+	return value;
+}
+
+ValueId SSABuilder::call_expression(CallExpression* expr) {
+	std::vector<ValueId> args{};
+	args.reserve(expr->args.size());
+	for (Expression* arg : expr->args) args.push_back(generate_expression(arg));
+
+	uint32_t callee{};
+	if (FunctionDeclarationStatement* func{constants.callee(expr)}) {
+		callee = symbol_of.at(func);
+	} else {
+		callee = module.symbol(static_cast<IdentifierExpression*>(expr->callee)->identifier.text());
+	}
+	ValueId result{emit(Opcode::CALL, expr->type, std::move(args), callee)};
+	state->func.blocks[state->block].instructions.back().effect = effects.effect(expr);
+	return result;
+}
+
+void SSABuilder::generate_statement(Statement* stmt) {
+	if (stack_exhausted()) return on_new_stack([&] { return generate_statement(stmt); });
+	visit(stmt, overloaded{
+		[&](VariableDeclarationStatement* decl) { variable_declaration_statement(decl); },
+		[&](FunctionDeclarationStatement* decl) { function_declaration_statement(decl); },
+		[&](ExpressionStatement* expr) {
+			// Code outside functions never runs.
+			if (state != nullptr && !effects.removable(expr->expr)) generate_expression(expr->expr);
+		},
+	});
+}
+
+void SSABuilder::variable_declaration_statement(VariableDeclarationStatement* stmt) {
+	uint32_t var{constants.variable(stmt)};
+
+	// As no code runs before main, a global starts as its initializer's
+	// value if that is known, and as zero otherwise.
+	if (state == nullptr) {
+		auto init{constants.fold(stmt->initializer)};
+		auto value{init ? Constant::of(stmt->type, init->bits) : std::nullopt};
+		std::string_view name{stmt->identifier->identifier.text()};
+		global_of.emplace(var, (uint32_t)module.globals.size());
+		module.globals.push_back({"_ZL" + std::to_string(name.size()) + std::string{name}, stmt->type, value ? value->bits : 0});
+		return;
+	}
+
+	ValueId value{generate_expression(stmt->initializer)};
+	if (constants.is_addressed(var)) {
+		state->slot_of.emplace(var, (uint32_t)state->func.slots.size());
+		state->func.slots.push_back(stmt->type);
+		emit(Opcode::STORE, nullptr, {*address_of(var, stmt->type), value});
+	} else {
+		write_variable(var, state->block, value);
+	}
+}
+
+void SSABuilder::function_declaration_statement(FunctionDeclarationStatement* stmt) {
+	// Only a generic's instances are generated.
+	if (!stmt->type_params.empty()) return;
+
+	std::string name{mangle_function(stmt)};
+	if (stmt->identifier->identifier.text() == "main") {
+		name = stmt->identifier->identifier.text();
+	}
+	symbol_of.emplace(stmt, module.symbol(name));
+
+	State inner{};
+	inner.func.name = name;
+	inner.func.return_type = stmt->return_type;
+	State* outer{std::exchange(state, &inner)};
+	state->block = new_block();
+	env_stack.push(stmt->identifier->identifier.symbol);
+
+	for (uint32_t i{0}; i < stmt->params.size(); i++) {
+		Type type{stmt->params[i].first};
+		state->func.params.push_back(type);
+		uint32_t var{constants.parameter(stmt, i)};
+		ValueId value{emit(Opcode::PARAMETER, type, {}, i)};
+		if (constants.is_addressed(var)) {
+			state->slot_of.emplace(var, (uint32_t)state->func.slots.size());
+			state->func.slots.push_back(type);
+			emit(Opcode::STORE, nullptr, {*address_of(var, type), value});
+		} else {
+			write_variable(var, state->block, value);
+		}
+	}
+
+	for (Statement* body_stmt : stmt->block->statements) {
+		// A return in the body itself ends the call; code after it is left
+		// in a block nothing reaches.
+		if (auto expr_stmt{node_cast<ExpressionStatement>(body_stmt)}) {
+			if (auto ret{node_cast<ReturnExpression>(expr_stmt->expr)}) {
+				ValueId value{generate_expression(ret)};
+				terminate(Opcode::RETURN, value != NO_ID ? std::vector<ValueId>{value} : std::vector<ValueId>{});
+				state->block = new_block();
+				continue;
+			}
+		}
+		generate_statement(body_stmt);
+	}
+	terminate(Opcode::RETURN);
+	env_stack.pop();
+
+	for (BlockId b{0}; b < state->func.blocks.size(); b++) {
+		auto& instructions{state->func.blocks[b].instructions};
+		instructions.insert(instructions.begin(), std::make_move_iterator(state->phis[b].begin()), std::make_move_iterator(state->phis[b].end()));
+	}
+	module.functions.push_back(std::move(state->func));
+	state = outer;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <stack>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ConstantEvaluator.h"
+#include "EffectAnalyzer.h"
+#include "SSA.h"
+#include "Syntax.h"
+
+// Lowers analyzed statements to SSA, following Braun et al.'s "Simple and
+// Efficient Construction of Static Single Assignment Form": a variable's
+// value is looked up in the block that reads it and, failing that, in its
+// predecessors, with a phi where several of them meet. Variables that are
+// pointed to live in memory instead, as do those outside any function.
+class SSABuilder {
+public:
+	// `stmts` must have passed analysis, with generics instantiated.
+	explicit SSABuilder(std::span<Statement* const> stmts)
+		: stmts{stmts}, constants{stmts}, effects{stmts, constants} { }
+
+	// Hands over the module; call once.
+	SSAModule run();
+
+private:
+	std::span<Statement* const> stmts{};
+	ConstantEvaluator constants;
+	EffectAnalyzer effects;
+	SSAModule module{};
+
+	// The function being built. A function declared inside another is built
+	// whole on a state of its own, then the outer one carries on.
+	struct State {
+		SSAFunction func{};
+		BlockId block{};
+		// The value of each variable each block defines or has looked up.
+		std::vector<std::unordered_map<uint32_t, ValueId>> definitions{};
+		// Phis are kept apart until the end, as they may be added to a block
+		// that already has a body.
+		std::vector<std::vector<Instruction>> phis{};
+		std::unordered_map<uint32_t, uint32_t> slot_of{};
+	};
+	State* state{};
+
+	std::unordered_map<uint32_t, uint32_t> global_of{};
+	std::unordered_map<const FunctionDeclarationStatement*, uint32_t> symbol_of{};
+
+	// Names of the functions and blocks the declaration under way is in.
+	std::stack<Symbol> env_stack{};
+	unsigned long long block_index{0};
+
+	std::string mangle_type(const Type& t);
+	std::string mangle_function(FunctionDeclarationStatement* func);
+
+	BlockId new_block();
+	void add_edge(BlockId from, BlockId to);
+	ValueId emit(Opcode op, Type type, std::vector<ValueId> operands = {}, uint64_t imm = 0);
+	void terminate(Opcode op, std::vector<ValueId> operands = {}, BlockId if_true = NO_ID, BlockId if_false = NO_ID);
+	ValueId constant(Type type, uint64_t bits) { return emit(Opcode::CONSTANT, type, {}, bits); }
+
+	void write_variable(uint32_t variable, BlockId block, ValueId value);
+	ValueId read_variable(uint32_t variable, Type type, BlockId block);
+	ValueId read_variable_recursive(uint32_t variable, Type type, BlockId block);
+
+	// The address of a variable kept in memory, if it is kept there.
+	std::optional<ValueId> address_of(uint32_t variable, Type type);
+	ValueId address_of(Expression* expr);
+	ValueId read(uint32_t variable, Type type);
+	void assign(Expression* target, ValueId value);
+
+	ValueId generate_expression(Expression* expr);
+	ValueId unary_expression(UnaryExpression* expr);
+	ValueId binary_expression(BinaryExpression* expr);
+	ValueId short_circuit(BinaryExpression* expr);
+	ValueId block_expression(BlockExpression* expr);
+	ValueId call_expression(CallExpression* expr);
+
+	void generate_statement(Statement* stmt);
+	void variable_declaration_statement(VariableDeclarationStatement* stmt);
+	void function_declaration_statement(FunctionDeclarationStatement* stmt);
+};
@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include "SSAOptimizer.h"
+#include "Stack.h"
+
+void SSAOptimizer::run() {
+	for (SSAFunction& func : module.functions) {
+		fold_branches(func);
+		// Edges from blocks nothing reaches would keep blocks from merging.
+		remove_unreachable(func);
+		merge_blocks(func);
+		remove_unreachable(func);
+		number_values(func);
+		remove_dead(func);
+	}
+}
+
+// Drops one edge into `block`, with its operand of every phi there.
+void SSAOptimizer::remove_predecessor(SSAFunction& func, BlockId block, BlockId pred) {
+	std::vector<BlockId>& preds{func.blocks[block].predecessors};
+	size_t index{(size_t)(std::ranges::find(preds, pred) - preds.begin())};
+	preds.erase(preds.begin() + index);
+	for (Instruction& inst : func.blocks[block].instructions) {
+		if (inst.op == Opcode::PHI) inst.operands.erase(inst.operands.begin() + index);
+	}
+}
+
+void SSAOptimizer::fold_branches(SSAFunction& func) {
+	std::vector<const Instruction*> constant(func.values.size());
+	for (const BasicBlock& block : func.blocks) {
+		for (const Instruction& inst : block.instructions) {
+			if (inst.op == Opcode::CONSTANT) constant[inst.result] = &inst;
+		}
+	}
+
+	for (BlockId b{0}; b < func.blocks.size(); b++) {
+		Instruction& last{func.blocks[b].instructions.back()};
+		if (last.op != Opcode::BRANCH || constant[last.operands[0]] == nullptr) continue;
+		bool taken{constant[last.operands[0]]->imm != 0};
+		remove_predecessor(func, last.targets[taken ? 1 : 0], b);
+		last = Instruction{Opcode::JUMP, nullptr, NO_ID, {}, 0, {last.targets[taken ? 0 : 1], NO_ID}};
+	}
+}
+
+// Follows replacements made in any order.
+void SSAOptimizer::replace_operands(SSAFunction& func) {
+	for (BasicBlock& block : func.blocks) {
+		for (Instruction& inst : block.instructions) {
+			for (ValueId& operand : inst.operands) {
+				while (replacement[operand] != operand) operand = replacement[operand];
+			}
+		}
+	}
+	replacement.clear();
+}
+
+// A merged block is left empty, and as nothing reaches it any more,
+// remove_unreachable() drops it.
+void SSAOptimizer::merge_blocks(SSAFunction& func) {
+	replacement.resize(func.values.size());
+	std::iota(replacement.begin(), replacement.end(), 0);
+	// The block each block's code is in now.
+	std::vector<BlockId> host(func.blocks.size());
+	std::iota(host.begin(), host.end(), 0);
+
+	for (BlockId b : func.reverse_postorder()) {
+		BasicBlock& block{func.blocks[b]};
+		std::erase_if(block.instructions, [&](const Instruction& inst) {
+			if (inst.op != Opcode::PHI || inst.operands.size() != 1) return false;
+			replacement[inst.result] = inst.operands[0];
+			return true;
+		});
+		if (block.predecessors.size() != 1) continue;
+		BasicBlock& into{func.blocks[host[block.predecessors[0]]]};
+		if (into.instructions.back().op != Opcode::JUMP) continue;
+
+		into.instructions.pop_back();
+		std::ranges::move(block.instructions, std::back_inserter(into.instructions));
+		block.instructions.clear();
+		block.predecessors.clear();
+		host[b] = (BlockId)(&into - func.blocks.data());
+		for (BlockId succ : func.successors(host[b])) {
+			std::ranges::replace(func.blocks[succ].predecessors, b, host[b]);
+		}
+	}
+	replace_operands(func);
+}
+
+void SSAOptimizer::remove_unreachable(SSAFunction& func) {
+	std::vector<BlockId> order{func.reverse_postorder()};
+	std::vector<BlockId> renamed(func.blocks.size(), NO_ID);
+	std::ranges::sort(order);
+	for (BlockId i{0}; i < order.size(); i++) renamed[order[i]] = i;
+	if (order.size() == func.blocks.size()) return;
+
+	std::vector<BasicBlock> blocks{};
+	blocks.reserve(order.size());
+	for (BlockId b : order) {
+		for (size_t i{func.blocks[b].predecessors.size()}; i-- > 0;) {
+			BlockId pred{func.blocks[b].predecessors[i]};
+			if (renamed[pred] == NO_ID) remove_predecessor(func, b, pred);
+		}
+		for (BlockId& pred : func.blocks[b].predecessors) pred = renamed[pred];
+		for (BlockId& target : func.blocks[b].instructions.back().targets) {
+			if (target != NO_ID) target = renamed[target];
+		}
+		blocks.push_back(std::move(func.blocks[b]));
+	}
+	func.blocks = std::move(blocks);
+}
+
+void SSAOptimizer::number_values(SSAFunction& func) {
+	std::vector<BlockId> idom{func.dominators()};
+	dominated.assign(func.blocks.size(), {});
+	for (BlockId b{1}; b < func.blocks.size(); b++) dominated[idom[b]].push_back(b);
+	replacement.resize(func.values.size());
+	std::iota(replacement.begin(), replacement.end(), 0);
+
+	number_values(func, 0);
+
+	// Phis read values from blocks that need not dominate theirs, so their
+	// operands are only settled once every block has been numbered.
+	replace_operands(func);
+}
+
+// The values numbered in the blocks that dominate `block` are available in
+// it; the ones numbered here are forgotten again on the way back up.
+void SSAOptimizer::number_values(SSAFunction& func, BlockId block) {
+	if (stack_exhausted()) return on_new_stack([&] { return number_values(func, block); });
+	std::vector<std::map<std::vector<uint64_t>, ValueId>::iterator> numbered{};
+	for (Instruction& inst : func.blocks[block].instructions) {
+		if (inst.op == Opcode::PHI) continue;
+		for (ValueId& operand : inst.operands) operand = replacement[operand];
+
+		bool is_value{inst.op <= Opcode::GLOBAL || (inst.op >= Opcode::ADD && inst.op <= Opcode::CAST)};
+		if (inst.op == Opcode::CALL && inst.effect == Effect::PURE) is_value = true;
+		if (inst.result == NO_ID || !is_value) continue;
+
+		std::vector<uint64_t> key{(uint64_t)inst.op, inst.type.id, inst.imm};
+		size_t first{key.size()};
+		key.insert(key.end(), inst.operands.begin(), inst.operands.end());
+		bool commutative{inst.op == Opcode::ADD || inst.op == Opcode::MUL ||
+			inst.op == Opcode::EQUAL || inst.op == Opcode::NOT_EQUAL};
+		if (commutative) std::sort(key.begin() + first, key.end());
+
+		auto [it, inserted]{available.try_emplace(std::move(key), inst.result)};
+		if (inserted) numbered.push_back(it);
+		else replacement[inst.result] = it->second;
+	}
+
+	for (BlockId child : dominated[block]) number_values(func, child);
+	for (auto it : numbered) available.erase(it);
+}
+
+// Stores, effectful calls and terminators stay, as does a division that
+// may trap; everything else stays only if something that stays uses it.
+void SSAOptimizer::remove_dead(SSAFunction& func) {
+	std::vector<const Instruction*> def(func.values.size());
+	for (const BasicBlock& block : func.blocks) {
+		for (const Instruction& inst : block.instructions) {
+			if (inst.result != NO_ID) def[inst.result] = &inst;
+		}
+	}
+
+	// Only a constant divisor is safe, and neither 0 nor, for a signed
+	// 64-bit division, -1, which overflows the minimum. Narrower types are
+	// divided in 64-bit registers.
+	auto may_trap{[&](const Instruction& div) {
+		const Instruction* divisor{def[div.operands[1]]};
+		if (divisor == nullptr || divisor->op != Opcode::CONSTANT || divisor->imm == 0) return true;
+		return div.type->is_signed() && div.type->get_size() == 8 && (int64_t)divisor->imm == -1;
+	}};
+
+	auto is_root{[&](const Instruction& inst) {
+		switch (inst.op) {
+			case Opcode::STORE: return true;
+			case Opcode::CALL: return inst.effect == Effect::EFFECTFUL;
+			case Opcode::DIV: return may_trap(inst);
+			default: return inst.is_terminator();
+		}
+	}};
+
+	std::vector<bool> live(func.values.size());
+	std::vector<ValueId> work{};
+	auto use{[&](const Instruction& inst) {
+		for (ValueId operand : inst.operands) {
+			if (!live[operand]) {
+				live[operand] = true;
+				work.push_back(operand);
+			}
+		}
+	}};
+	for (const BasicBlock& block : func.blocks) {
+		for (const Instruction& inst : block.instructions) {
+			if (!is_root(inst)) continue;
+			use(inst);
+			if (inst.result != NO_ID) live[inst.result] = true;
+		}
+	}
+	while (!work.empty()) {
+		ValueId value{work.back()};
+		work.pop_back();
+		if (def[value] != nullptr) use(*def[value]);
+	}
+
+	// Erasing moves the instructions `def` points at, so roots with a
+	// result are only told apart by being live.
+	for (BasicBlock& block : func.blocks) {
+		std::erase_if(block.instructions, [&](const Instruction& inst) {
+			return inst.result == NO_ID ? !is_root(inst) : !live[inst.result];
+		});
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "SSA.h"
+
+// Cleans up the SSA a function is built as, in place. A branch on a
+// constant becomes a jump, a block only ever jumped to from one other is
+// joined to its end, and blocks nothing reaches are dropped. Then a
+// value computed again where an equal one is already known, on every path,
+// is replaced by it: global value numbering over the dominator tree, where
+// calls count when they are pure. Last, instructions whose results go
+// unused and that do nothing else are removed.
+class SSAOptimizer {
+public:
+	explicit SSAOptimizer(SSAModule& module) : module{module} { }
+
+	void run();
+
+private:
+	SSAModule& module;
+
+	// What each value of the function at hand stands for now.
+	std::vector<ValueId> replacement{};
+	// Of the function being numbered.
+	std::vector<std::vector<BlockId>> dominated{};
+	std::map<std::vector<uint64_t>, ValueId> available{};
+
+	static void remove_predecessor(SSAFunction& func, BlockId block, BlockId pred);
+	void replace_operands(SSAFunction& func);
+
+	void fold_branches(SSAFunction& func);
+	void merge_blocks(SSAFunction& func);
+	void remove_unreachable(SSAFunction& func);
+	void number_values(SSAFunction& func);
+	void number_values(SSAFunction& func, BlockId block);
+	void remove_dead(SSAFunction& func);
+};
@@ -0,0 +1,190 @@
+#include <bit>
+#include <cstdint>
+#include "Scan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ROC_SCAN_X86
+#endif
+
+static bool is_whitespace(char c) {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool is_digit(char c) {
+	return (unsigned char)(c - '0') < 10u;
+}
+
+static bool is_identifier(char c) {
+	return is_digit(c) || (unsigned char)((c | 0x20) - 'a') < 26u || c == '_';
+}
+
+static const char* scalar_skip_whitespace(const char* p, const char* end) {
+	while (p < end && is_whitespace(*p)) p++;
+	return p;
+}
+
+static const char* scalar_identifier_end(const char* p, const char* end) {
+	while (p < end && is_identifier(*p)) p++;
+	return p;
+}
+
+static const char* scalar_number_end(const char* p, const char* end) {
+	while (p < end && is_digit(*p)) p++;
+	return p;
+}
+
+#ifdef ROC_SCAN_X86
+
+// Signed compares only: shift [lo, hi] down to start at -128 and test
+// against the top of the shifted range.
+static inline __m128i in_range_128(__m128i v, char lo, char hi) {
+	__m128i shifted{_mm_add_epi8(v, _mm_set1_epi8((char)(0x80 - (unsigned char)lo)))};
+	return _mm_cmplt_epi8(shifted, _mm_set1_epi8((char)(-128 + (hi - lo) + 1)));
+}
+
+static inline __m128i whitespace_128(__m128i v) {
+	return _mm_or_si128(
+		_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+		_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')))
+	);
+}
+
+static inline __m128i identifier_128(__m128i v) {
+	__m128i lower{_mm_or_si128(v, _mm_set1_epi8(0x20))};
+	return _mm_or_si128(
+		_mm_or_si128(in_range_128(v, '0', '9'), in_range_128(lower, 'a', 'z')),
+		_mm_cmpeq_epi8(v, _mm_set1_epi8('_'))
+	);
+}
+
+// Runs while `classify` holds; stops at the first byte it rejects.
+template <typename Classify, typename Scalar>
+static inline const char* sse2_run(const char* p, const char* end, Classify classify, Scalar scalar) {
+	while (end - p >= 16) {
+		__m128i v{_mm_loadu_si128((const __m128i*)p)};
+		unsigned int stop{~(unsigned int)_mm_movemask_epi8(classify(v)) & 0xFFFFu};
+		if (stop != 0u) return p + std::countr_zero(stop);
+		p += 16;
+	}
+	return scalar(p, end);
+}
+
+static const char* sse2_skip_whitespace(const char* p, const char* end) {
+	return sse2_run(p, end, whitespace_128, scalar_skip_whitespace);
+}
+
+static const char* sse2_identifier_end(const char* p, const char* end) {
+	return sse2_run(p, end, identifier_128, scalar_identifier_end);
+}
+
+static inline __m128i digit_128(__m128i v) {
+	return in_range_128(v, '0', '9');
+}
+
+static const char* sse2_number_end(const char* p, const char* end) {
+	return sse2_run(p, end, digit_128, scalar_number_end);
+}
+
+#define ROC_AVX2 __attribute__((target("avx2")))
+
+ROC_AVX2 static inline __m256i in_range_256(__m256i v, char lo, char hi) {
+	__m256i shifted{_mm256_add_epi8(v, _mm256_set1_epi8((char)(0x80 - (unsigned char)lo)))};
+	return _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(-128 + (hi - lo) + 1)), shifted);
+}
+
+ROC_AVX2 static inline __m256i whitespace_256(__m256i v) {
+	return _mm256_or_si256(
+		_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+		_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')))
+	);
+}
+
+ROC_AVX2 static inline __m256i identifier_256(__m256i v) {
+	__m256i lower{_mm256_or_si256(v, _mm256_set1_epi8(0x20))};
+	return _mm256_or_si256(
+		_mm256_or_si256(in_range_256(v, '0', '9'), in_range_256(lower, 'a', 'z')),
+		_mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'))
+	);
+}
+
+ROC_AVX2 static inline __m256i digit_256(__m256i v) {
+	return in_range_256(v, '0', '9');
+}
+
+// Most runs are short, so one 16-byte step goes first and only longer runs
+// pay for the 32-byte loop.
+#define ROC_AVX2_RUN(classify, classify_128, tail) \
+	if (end - p >= 16) { \
+		__m128i v{_mm_loadu_si128((const __m128i*)p)}; \
+		unsigned int stop{~(unsigned int)_mm_movemask_epi8(classify_128(v)) & 0xFFFFu}; \
+		if (stop != 0u) return p + std::countr_zero(stop); \
+		p += 16; \
+	} \
+	while (end - p >= 32) { \
+		__m256i v{_mm256_loadu_si256((const __m256i*)p)}; \
+		uint32_t stop{~(uint32_t)_mm256_movemask_epi8(classify(v))}; \
+		if (stop != 0u) return p + std::countr_zero(stop); \
+		p += 32; \
+	} \
+	return tail(p, end);
+
+ROC_AVX2 static const char* avx2_skip_whitespace(const char* p, const char* end) {
+	ROC_AVX2_RUN(whitespace_256, whitespace_128, sse2_skip_whitespace)
+}
+
+ROC_AVX2 static const char* avx2_identifier_end(const char* p, const char* end) {
+	ROC_AVX2_RUN(identifier_256, identifier_128, sse2_identifier_end)
+}
+
+ROC_AVX2 static const char* avx2_number_end(const char* p, const char* end) {
+	ROC_AVX2_RUN(digit_256, digit_128, sse2_number_end)
+}
+
+#endif
+
+static constexpr ScanKernels SCALAR_KERNELS{
+	scalar_skip_whitespace, scalar_identifier_end, scalar_number_end
+};
+
+#ifdef ROC_SCAN_X86
+static constexpr ScanKernels SSE2_KERNELS{
+	sse2_skip_whitespace, sse2_identifier_end, sse2_number_end
+};
+static constexpr ScanKernels AVX2_KERNELS{
+	avx2_skip_whitespace, avx2_identifier_end, avx2_number_end
+};
+#endif
+
+static ScanMode active_mode{best_scan_mode()};
+
+ScanMode best_scan_mode() noexcept {
+#ifdef ROC_SCAN_X86
+	static const ScanMode best{[] {
+		__builtin_cpu_init();
+		return (__builtin_cpu_supports("avx2") ? ScanMode::AVX2 : ScanMode::SSE2);
+	}()};
+	return best;
+#else
+	return ScanMode::SCALAR;
+#endif
+}
+
+ScanMode set_scan_mode(ScanMode mode) noexcept {
+	active_mode = ((int)mode <= (int)best_scan_mode() ? mode : best_scan_mode());
+	return active_mode;
+}
+
+ScanMode get_scan_mode() noexcept {
+	return active_mode;
+}
+
+const ScanKernels& scan_kernels() noexcept {
+	switch (active_mode) {
+#ifdef ROC_SCAN_X86
+		case ScanMode::AVX2: return AVX2_KERNELS;
+		case ScanMode::SSE2: return SSE2_KERNELS;
+#endif
+		default: return SCALAR_KERNELS;
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstring>
+
+// Byte-classification kernels behind Lexer::scan_token. Each returns the
+// first position in [p, end) that stops the run (or end). The vector
+// variants classify 16 or 32 bytes per step and never read past end.
+enum class ScanMode {
+	SCALAR, SSE2, AVX2
+};
+
+struct ScanKernels {
+	const char* (*skip_whitespace)(const char* p, const char* end);
+	const char* (*identifier_end)(const char* p, const char* end);
+	const char* (*number_end)(const char* p, const char* end);
+};
+
+// Best mode the running CPU supports; picked once on first use.
+ScanMode best_scan_mode() noexcept;
+
+// Forces a mode (clamped to what the CPU supports) and returns the one used.
+ScanMode set_scan_mode(ScanMode mode) noexcept;
+ScanMode get_scan_mode() noexcept;
+
+const ScanKernels& scan_kernels() noexcept;
+
+// Single-byte searches (comment and string ends) go to memchr, which libc
+// already vectorizes for the running CPU.
+inline const char* find_byte(const char* p, const char* end, char c) noexcept {
+	const void* found{std::memchr(p, c, end - p)};
+	return (found != nullptr ? (const char*)found : end);
+}
@@ -0,0 +1,696 @@
+#include <algorithm>
+#include <ranges>
+#include "SemanticAnalyzer.h"
+#include "ErrorHandling.h"
+#include "SemanticChecks.h"
+#include "Stack.h"
+
+static constexpr const char* SLOT_MESSAGES[]{
+	nullptr,
+	"Unable to infer identifier type.",
+	"Unable to infer literal type.",
+	"Unable to infer unary expression result type.",
+	"Unable to infer binary expression result type.",
+	"Unable to infer block's type.",
+	"Unable to infer function call return type.",
+	"Unable to infer function call argument type.",
+	"Unable to infer return expression type.",
+	"Unable to infer variable type on declaration.",
+	"Unable to infer function parameter type.",
+	"Unable to infer function return type.",
+};
+
+static Function function_of(FunctionDeclarationStatement* stmt) {
+	std::vector<Variable> params{(stmt->params | std::views::transform([](const std::pair<Type, Token>& param) {
+		return Variable{param.first, param.second};
+	})) | std::ranges::to<std::vector>()};
+	return Function{stmt->return_type, stmt->identifier->identifier, params, stmt->type_params.empty() ? nullptr : stmt};
+}
+
+// A type parameter left in a type outside any generic that declares it.
+static bool names_parameter(Type type) {
+	if (type_cast<TParameter>(type) != nullptr) return true;
+	if (auto ptr{type_cast<TPointer>(type)}) return names_parameter(ptr->inner);
+	return false;
+}
+
+void SemanticAnalyzer::semantic_error(const Token& token, const std::string& message) {
+	error(token, message);
+	success = false;
+}
+
+bool SemanticAnalyzer::infer() {
+	for (Statement* stmt : stmts) {
+		infer_statement(stmt, 0);
+		for (size_t i{0}; i < queued.size(); i++) {
+			auto [instance, instance_depth]{queued[i]};
+			infer_statement(instance, instance_depth);
+		}
+		queued.clear();
+	}
+	for (const Instantiation& inst : pending) {
+		semantic_error(inst.call->closing_paren, "Unable to infer type arguments of generic function call.");
+	}
+	substitute_slots();
+	return success;
+}
+
+void SemanticAnalyzer::infer_statement(Statement* stmt, uint32_t depth) {
+	caller = stmt;
+	this->depth = depth;
+
+	unifier.open_scope();
+	size_t first_slot{slots.size()};
+	size_t first_return{returns.size()};
+	size_t first_check{checks.size()};
+	analyze_statement(stmt);
+	unifier.solve();
+
+	if (auto waiting{awaiting_return.find(stmt)}; waiting != awaiting_return.end()) {
+		for (CallExpression* call : waiting->second) {
+			unifier.constrain(call->type, static_cast<FunctionDeclarationStatement*>(stmt)->return_type);
+		}
+		awaiting_return.erase(waiting);
+	}
+	instantiate();
+	unifier.solve();
+
+	settle(stmt, first_slot, first_return, first_check);
+	unifier.close_scope();
+}
+
+// Gives each generic call whose type arguments are now ground its instance.
+// The others wait for a later statement to settle them.
+void SemanticAnalyzer::instantiate() {
+	size_t kept{0};
+	for (size_t i{0}; i < pending.size(); i++) {
+		Instantiation& inst{pending[i]};
+		for (Type& arg : inst.args) arg = unifier.substitute(arg);
+		if (!std::ranges::all_of(inst.args, is_ground)) {
+			for (const Type& arg : inst.args) unifier.retain(arg);
+			if (kept != i) pending[kept] = std::move(inst);
+			kept++;
+			continue;
+		}
+		if (inst.depth >= MAX_INSTANTIATION_DEPTH) {
+			semantic_error(inst.call->closing_paren, "Generic function instantiated too deeply.");
+			continue;
+		}
+
+		bool created{};
+		FunctionDeclarationStatement* instance{monomorphizer.instantiate(inst.generic, inst.args, created)};
+		if (created) {
+			queued.emplace_back(instance, inst.depth + 1);
+			awaiting_return[instance];
+		}
+		if (auto waiting{awaiting_return.find(instance)}; waiting != awaiting_return.end()) {
+			waiting->second.push_back(inst.call);
+		} else {
+			unifier.constrain(inst.call->type, instance->return_type);
+		}
+		instance_calls.emplace_back(inst.call, instance);
+		called_instances[inst.caller].push_back(instance);
+	}
+	pending.resize(kept);
+}
+
+bool SemanticAnalyzer::check() {
+	for (size_t i{0}; i < checks.size(); i++) {
+		run_check(i);
+	}
+	if (!success) return false;
+
+	for (auto [call, instance] : instance_calls) {
+		if (call->type != instance->return_type) {
+			error(call->closing_paren, "Mismatched types between call and function return.");
+			success = false;
+		}
+	}
+	if (!success) return false;
+
+	for (auto [call, instance] : instance_calls) {
+		call->callee = arena.make<IdentifierExpression>(instance->identifier->identifier);
+	}
+	return true;
+}
+
+std::vector<Statement*> SemanticAnalyzer::program() const {
+	std::vector<Statement*> ordered{};
+	std::unordered_set<const Statement*> placed{};
+	for (Statement* stmt : stmts) {
+		place(stmt, ordered, placed);
+	}
+	return ordered;
+}
+
+// Instances come before whatever calls them, so that every pass after this
+// one still meets each function before its calls.
+void SemanticAnalyzer::place(Statement* stmt, std::vector<Statement*>& ordered, std::unordered_set<const Statement*>& placed) const {
+	if (stack_exhausted()) return on_new_stack([&] { return place(stmt, ordered, placed); });
+	if (auto it{called_instances.find(stmt)}; it != called_instances.end()) {
+		for (FunctionDeclarationStatement* instance : it->second) {
+			if (placed.insert(instance).second) place(instance, ordered, placed);
+		}
+	}
+	ordered.push_back(stmt);
+}
+
+void SemanticAnalyzer::substitute_slots() {
+	for (size_t i{0}; i < slots.size(); i++) {
+		const Slot& slot{slots[i]};
+		if (slot.kind == SlotKind::RETURNS) {
+			auto rets{std::span{returns}.subspan(slot.first, slot.count)};
+			if (!std::ranges::all_of(rets, [&](ReturnExpression* ret) { return ret->type == rets.front()->type; })) {
+				semantic_error(*slot.token, "All return types of a single block must be the same.");
+				i++;
+			}
+			continue;
+		}
+
+		*slot.type = unifier.substitute(*slot.type);
+		if (slot.message != SlotMessage::NONE && !is_inferred(*slot.type)) {
+			semantic_error(*slot.token, SLOT_MESSAGES[(size_t)slot.message]);
+		}
+	}
+}
+
+// Once a top-level statement is solved, most of its types are final: those
+// are substituted now and their slots dropped. Only the rest, and what the
+// statement declares, keep the unifier's variables alive until the end.
+void SemanticAnalyzer::settle(Statement* stmt, size_t first_slot, size_t first_return, size_t first_check) {
+	// The environment holds the declared types as they were before substitution.
+	visit(stmt, overloaded{
+		[&](ExpressionStatement*) { },
+		[&](VariableDeclarationStatement* decl) { unifier.retain(decl->type); },
+		[&](FunctionDeclarationStatement* func) {
+			unifier.retain(func->return_type);
+			for (const auto& param : func->params) unifier.retain(param.first);
+		},
+	});
+
+	auto keep{[&](Type* type) {
+		*type = unifier.substitute(*type);
+		unifier.retain(*type);
+	}};
+
+	size_t kept{first_slot};
+	size_t kept_returns{first_return};
+	for (size_t i{first_slot}; i < slots.size(); i++) {
+		Slot slot{slots[i]};
+		if (slot.kind == SlotKind::RETURNS) {
+			auto rets{std::span{returns}.subspan(slot.first, slot.count)};
+			if (std::ranges::all_of(rets, [&](ReturnExpression* ret) { return is_ground(ret->type) && ret->type == rets.front()->type; })) {
+				continue;
+			}
+			// Not settled yet, or failing: the block's own slot stays right after it.
+			std::ranges::copy(rets, returns.begin() + kept_returns);
+			slot.first = (uint32_t)kept_returns;
+			kept_returns += slot.count;
+			slots[kept++] = slot;
+			keep(slots[++i].type);
+			slots[kept++] = slots[i];
+			continue;
+		}
+
+		*slot.type = unifier.substitute(*slot.type);
+		if (is_ground(*slot.type)) continue;
+		unifier.retain(*slot.type);
+		slots[kept++] = slot;
+	}
+	slots.resize(kept);
+	returns.resize(kept_returns);
+
+	for (size_t i{first_check}; i < checks.size(); i++) {
+		if (checks[i].kind == CheckKind::ARGUMENT_TYPE && checks[i].param != nullptr) keep(&checks[i].param);
+	}
+}
+
+void SemanticAnalyzer::fail(size_t at) {
+	success = false;
+	if (!environment) replay_environment(at);
+}
+
+// Builds the checks' environment as it stands at check `at`, which is
+// the first to fail, so every declaration before it went through.
+void SemanticAnalyzer::replay_environment(size_t at) {
+	environment.emplace();
+	for (size_t i{0}; i < at; i++) {
+		apply_scope(checks[i]);
+		if (checks[i].kind == CheckKind::VARIABLE) {
+			auto decl{static_cast<VariableDeclarationStatement*>(checks[i].stmt)};
+			environment->declare(Variable{decl->type, decl->identifier->identifier});
+		}
+	}
+}
+
+void SemanticAnalyzer::apply_scope(const Check& check) {
+	switch (check.kind) {
+		case CheckKind::PUSH:
+			environment->push();
+			return;
+		case CheckKind::POP:
+			environment->pop();
+			return;
+		case CheckKind::ENTER_FUNCTION:
+			floors.push_back(environment->enter_function());
+			return;
+		case CheckKind::LEAVE_FUNCTION:
+			environment->leave_function(floors.back());
+			floors.pop_back();
+			return;
+		case CheckKind::PARAMETER: {
+			const auto& param{static_cast<FunctionDeclarationStatement*>(check.stmt)->params[check.index]};
+			environment->declare(Variable{param.first, param.second});
+			return;
+		}
+		case CheckKind::FUNCTION:
+			environment->declare(function_of(static_cast<FunctionDeclarationStatement*>(check.stmt)));
+			return;
+		default:
+			return;
+	}
+}
+
+void SemanticAnalyzer::run_check(size_t& i) {
+	const Check& check{checks[i]};
+	switch (check.kind) {
+		case CheckKind::PUSH:
+		case CheckKind::POP:
+		case CheckKind::ENTER_FUNCTION:
+		case CheckKind::LEAVE_FUNCTION:
+		case CheckKind::PARAMETER:
+			if (environment) apply_scope(check);
+			return;
+		case CheckKind::IDENTIFIER: {
+			auto id{static_cast<IdentifierExpression*>(check.expr)};
+			if (environment && !environment->get_identifier_type(id->identifier)) {
+				error(id->identifier, "Identifier not defined.");
+				return fail(i);
+			}
+			id->lvalue = true;
+			return;
+		}
+		case CheckKind::GROUPING: {
+			auto group{static_cast<GroupingExpression*>(check.expr)};
+			group->lvalue = group->expr->lvalue;
+			return;
+		}
+		case CheckKind::UNARY:
+			if (!check_unary(static_cast<UnaryExpression*>(check.expr))) fail(i);
+			return;
+		case CheckKind::BINARY:
+			if (!check_binary(static_cast<BinaryExpression*>(check.expr))) fail(i);
+			return;
+		case CheckKind::CALL: {
+			if (!environment) return;
+			auto call{static_cast<CallExpression*>(check.expr)};
+			size_t params{};
+			if (auto id{node_cast<IdentifierExpression>(call->callee)}) {
+				if (auto func{environment->get_function(id->identifier)}) {
+					params = func->args.size();
+				} else {
+					error(id->identifier, "No function of that name.");
+					fail(i);
+				}
+			} else {
+				error(call->closing_paren, "Function callee must be an identifier");
+				fail(i);
+			}
+			if (call->args.size() != params) {
+				error(call->closing_paren, "Different number of arguments than parameters.");
+				fail(i);
+			}
+			return;
+		}
+		case CheckKind::ARGUMENT: {
+			if (!environment) return;
+			auto id{node_cast<IdentifierExpression>(static_cast<CallExpression*>(check.expr)->callee)};
+			auto func{id != nullptr ? environment->get_function(id->identifier) : nullptr};
+			if (func == nullptr || check.index >= func->args.size()) i = check.end - 1;
+			return;
+		}
+		case CheckKind::ARGUMENT_TYPE: {
+			auto call{static_cast<CallExpression*>(check.expr)};
+			Type param{unifier.substitute(check.param)};
+			if (environment) {
+				auto id{static_cast<IdentifierExpression*>(call->callee)};
+				const Function* func{environment->get_function(id->identifier)};
+				// A generic's own parameter types name its type parameters.
+				if (func->generic == nullptr) param = func->args[check.index].type;
+			}
+			if (call->args[check.index]->type != param) {
+				error(call->closing_paren, "Mismatched types between argument and parameter.");
+				fail(i);
+			}
+			return;
+		}
+		case CheckKind::DECLARATION: {
+			auto id{static_cast<IdentifierExpression*>(check.expr)};
+			if (environment ? environment->has_identifier(id->identifier) : check.defined) {
+				error(id->identifier, "Identifier already defined.");
+				fail(i);
+				i = check.end - 1;
+			}
+			return;
+		}
+		case CheckKind::VARIABLE: {
+			auto decl{static_cast<VariableDeclarationStatement*>(check.stmt)};
+			if (!check_variable_declaration(decl)) return fail(i);
+			if (environment) environment->declare(Variable{decl->type, decl->identifier->identifier});
+			return;
+		}
+		case CheckKind::FUNCTION: {
+			auto func{static_cast<FunctionDeclarationStatement*>(check.stmt)};
+			if (func->type_params.empty() && !check_function_declaration(func)) {
+				fail(i);
+			}
+			if (environment) apply_scope(check);
+			return;
+		}
+	}
+}
+
+void SemanticAnalyzer::analyze_expression(Expression* expr) {
+	if (stack_exhausted()) return on_new_stack([&] { return analyze_expression(expr); });
+	visit(expr, overloaded{
+		[&](IdentifierExpression* id) { analyze_identifier_expression(id); },
+		[&](LiteralExpression* lit) { analyze_literal_expression(lit); },
+		[&](GroupingExpression* group) { analyze_grouping_expression(group); },
+		[&](UnaryExpression* un) { analyze_unary_expression(un); },
+		[&](BinaryExpression* bin) { analyze_binary_expression(bin); },
+		[&](BlockExpression* block) { analyze_block_expression(block); },
+		[&](CallExpression* call) { analyze_call_expression(call); },
+		[&](ReturnExpression* ret) { analyze_return_expression(ret); },
+		[&](CastExpression* cast) { analyze_cast_expression(cast); },
+	});
+}
+
+void SemanticAnalyzer::resolve_identifier(IdentifierExpression* expr) {
+	if (auto t{env_stack.get_identifier_type(expr->identifier)}) {
+		expr->type = t.value();
+	} else {
+		semantic_error(expr->identifier, "Identifier not defined.");
+	}
+	record({.kind = CheckKind::IDENTIFIER, .end = 0, .expr = expr});
+}
+
+void SemanticAnalyzer::analyze_identifier_expression(IdentifierExpression* expr) {
+	resolve_identifier(expr);
+	slot(&expr->type, &expr->identifier, SlotMessage::IDENTIFIER);
+}
+
+void SemanticAnalyzer::analyze_literal_expression(LiteralExpression* expr) {
+	switch (expr->value.type) {
+		case TokenType::TRUE:
+		case TokenType::FALSE:
+			expr->type = Type::of(TypeEnum::BOOL);
+			break;
+		case TokenType::NUMBER_LITERAL: {
+			auto suffix{std::ranges::find_if(number_types, [&](const RealType& type) {
+				return expr->value.text().ends_with(type.keyword.first);
+			})};
+			expr->type = (suffix != number_types.end() ? Type::constructor(*suffix) : unifier.fresh_type_variable());
+			break;
+		}
+		case TokenType::STRING_LITERAL:
+			expr->type = Type::pointer_to(Type::of(TypeEnum::I8));
+			break;
+		case TokenType::CHAR_LITERAL:
+			expr->type = Type::of(TypeEnum::I8);
+			break;
+		default:
+			expr->type = nullptr;
+			break;
+	}
+	slot(&expr->type, &expr->value, SlotMessage::LITERAL);
+}
+
+void SemanticAnalyzer::analyze_grouping_expression(GroupingExpression* expr) {
+	analyze_expression(expr->expr);
+	expr->type = expr->expr->type;
+	slot(&expr->type);
+	record({.kind = CheckKind::GROUPING, .end = 0, .expr = expr});
+}
+
+void SemanticAnalyzer::analyze_unary_expression(UnaryExpression* expr) {
+	analyze_expression(expr->expr);
+	switch (expr->op.type) {
+		case TokenType::NOT:
+			expr->type = Type::of(TypeEnum::BOOL);
+			break;
+		case TokenType::MINUS:
+			expr->type = expr->expr->type;
+			break;
+		case TokenType::STAR:
+			if (is_pointer(expr->expr->type)) {
+				expr->type = type_cast<TPointer>(expr->expr->type)->inner;
+			} else {
+				expr->type = unifier.fresh_type_variable();
+				unifier.constrain(expr->expr->type, Type::pointer_to(expr->type));
+			}
+			break;
+		case TokenType::AMPERSAND:
+			expr->type = Type::pointer_to(expr->expr->type);
+			break;
+		default:
+			semantic_error(expr->op, "Invalid unary operation.");
+	}
+	slot(&expr->type, &expr->op, SlotMessage::UNARY);
+	record({.kind = CheckKind::UNARY, .end = 0, .expr = expr});
+}
+
+void SemanticAnalyzer::analyze_binary_expression(BinaryExpression* expr) {
+	analyze_expression(expr->sides.first);
+	analyze_expression(expr->sides.second);
+
+	unifier.constrain(expr->sides.first->type, expr->sides.second->type);
+
+	switch (expr->op.type) {
+		case TokenType::PLUS:
+		case TokenType::MINUS:
+		case TokenType::STAR:
+		case TokenType::SLASH:
+		case TokenType::EQUAL_EQUAL:
+		case TokenType::NOT_EQUAL:
+		case TokenType::GREATER:
+		case TokenType::GREATER_EQUAL:
+		case TokenType::LESS:
+		case TokenType::LESS_EQUAL:
+		case TokenType::EQUAL:
+			expr->type = unifier.fresh_type_variable();
+			unifier.constrain(expr->type, expr->sides.first->type);
+			break;
+		case TokenType::AND:
+		case TokenType::OR:
+			expr->type = Type::of(TypeEnum::BOOL);
+			break;
+		default:
+			semantic_error(expr->op, "Invalid binary operation.");
+	}
+	slot(&expr->type, &expr->op, SlotMessage::BINARY);
+	record({.kind = CheckKind::BINARY, .end = 0, .expr = expr});
+}
+
+void SemanticAnalyzer::analyze_block_expression(BlockExpression* expr, FunctionDeclarationStatement* func) {
+	env_stack.push();
+	record({.kind = CheckKind::PUSH, .end = 0, .expr = nullptr});
+
+	if (func != nullptr) {
+		for (uint32_t i{0}; i < func->params.size(); i++) {
+			env_stack.declare(Variable{func->params[i].first, func->params[i].second});
+			record({.kind = CheckKind::PARAMETER, .index = i, .end = 0, .stmt = func});
+		}
+	}
+
+	expr->type = unifier.fresh_type_variable();
+
+	std::vector<ReturnExpression*> rets{};
+	for (Statement* stmt : expr->statements) {
+		analyze_statement(stmt);
+
+		if (auto expr_stmt{node_cast<ExpressionStatement>(stmt)}) {
+			if (auto ret{node_cast<ReturnExpression>(expr_stmt->expr)}) {
+				rets.push_back(ret);
+			}
+		}
+	}
+
+	if (rets.empty()) {
+		expr->type = Type::of(TypeEnum::NONE);
+	} else {
+		unifier.constrain(expr->type, rets[0]->type);
+		slots.push_back({.kind = SlotKind::RETURNS, .first = (uint32_t)returns.size(), .token = &rets[0]->return_tok, .count = (uint32_t)rets.size()});
+		returns.insert(returns.end(), rets.begin(), rets.end());
+	}
+	slot(&expr->type, &expr->opening_block, SlotMessage::BLOCK);
+
+	env_stack.pop();
+	record({.kind = CheckKind::POP, .end = 0, .expr = nullptr});
+}
+
+void SemanticAnalyzer::analyze_call_expression(CallExpression* expr) {
+	// The call's own slot is substituted before its arguments and checked after.
+	slot(&expr->type);
+
+	auto callee{node_cast<IdentifierExpression>(expr->callee)};
+	const Function* func{callee != nullptr ? env_stack.get_function(callee->identifier) : nullptr};
+	if (func == nullptr) {
+		if (callee != nullptr) {
+			semantic_error(callee->identifier, "No function of that name.");
+			record({.kind = CheckKind::IDENTIFIER, .end = 0, .expr = callee});
+		} else {
+			semantic_error(expr->closing_paren, "Function callee must be an identifier");
+		}
+		expr->type = unifier.fresh_type_variable();
+	} else {
+		expr->type = func->return_type;
+		resolve_identifier(callee);
+		if (func->args.size() != expr->args.size()) {
+			semantic_error(expr->closing_paren, "Different number of arguments than parameters.");
+		}
+	}
+
+	// A generic's signature is instantiated with a fresh variable per type
+	// parameter, which the arguments and the call's use then settle.
+	std::vector<Type> type_args{};
+	if (func != nullptr && func->generic != nullptr) {
+		for (size_t i{0}; i < func->generic->type_params.size(); i++) {
+			type_args.push_back(unifier.fresh_type_variable());
+		}
+		expr->type = (func->return_type != nullptr
+			? Monomorphizer::substitute(func->return_type, func->generic->type_params, type_args)
+			: unifier.fresh_type_variable());
+	}
+	record({.kind = CheckKind::CALL, .end = 0, .expr = expr});
+
+	analyze_arguments(expr, func, type_args);
+	if (func != nullptr && func->generic != nullptr) {
+		pending.push_back({expr, func->generic, std::move(type_args), caller, depth});
+	}
+
+	slot(&expr->type, &expr->closing_paren, SlotMessage::CALL);
+}
+
+void SemanticAnalyzer::analyze_arguments(CallExpression* expr, const Function* func, std::span<const Type> type_args) {
+	for (uint32_t i{0}; i < expr->args.size(); i++) {
+		Type param{func != nullptr && i < func->args.size() ? func->args[i].type : nullptr};
+		if (param != nullptr && func->generic != nullptr) {
+			param = Monomorphizer::substitute(param, func->generic->type_params, type_args);
+		}
+		uint32_t argument{record({.kind = CheckKind::ARGUMENT, .index = i, .end = 0, .expr = expr})};
+
+		analyze_expression(expr->args[i]);
+		if (param != nullptr) unifier.constrain(expr->args[i]->type, param);
+
+		slot(&expr->args[i]->type, &expr->closing_paren, SlotMessage::ARGUMENT);
+		record({.kind = CheckKind::ARGUMENT_TYPE, .index = i, .param = param, .expr = expr});
+		end_range(argument);
+	}
+}
+
+void SemanticAnalyzer::analyze_return_expression(ReturnExpression* expr) {
+	analyze_expression(expr->return_expression);
+	expr->type = expr->return_expression->type;
+	slot(&expr->type, &expr->return_tok, SlotMessage::RETURN);
+}
+
+void SemanticAnalyzer::analyze_cast_expression(CastExpression* expr) {
+	bool was_checking{std::exchange(checking, false)};
+	analyze_expression(expr->expr);
+	checking = was_checking;
+
+	expr->type = expr->cast_type;
+	if (names_parameter(expr->type)) {
+		semantic_error(expr->as, "Type not defined.");
+		expr->type = unifier.fresh_type_variable();
+	}
+	slot(&expr->type);
+}
+
+void SemanticAnalyzer::analyze_statement(Statement* stmt) {
+	if (stack_exhausted()) return on_new_stack([&] { return analyze_statement(stmt); });
+	visit(stmt, overloaded{
+		[&](ExpressionStatement* expr) { analyze_expression(expr->expr); },
+		[&](VariableDeclarationStatement* var_decl) { analyze_variable_declaration_statement(var_decl); },
+		[&](FunctionDeclarationStatement* func_decl) { analyze_function_declaration_statement(func_decl); },
+	});
+}
+
+void SemanticAnalyzer::analyze_variable_declaration_statement(VariableDeclarationStatement* stmt) {
+	const Token& name{stmt->identifier->identifier};
+	uint32_t declaration{record({.kind = CheckKind::DECLARATION, .defined = env_stack.has_identifier(name), .end = 0, .expr = stmt->identifier})};
+
+	if (names_parameter(stmt->type)) {
+		semantic_error(name, "Type not defined.");
+		stmt->type = nullptr;
+	}
+	if (stmt->type == nullptr) {
+		stmt->type = unifier.fresh_type_variable();
+	}
+
+	analyze_expression(stmt->initializer);
+
+	unifier.constrain(stmt->type, stmt->initializer->type);
+
+	env_stack.declare(Variable{stmt->type, name});
+
+	slot(&stmt->type, &name, SlotMessage::VARIABLE);
+	record({.kind = CheckKind::VARIABLE, .end = 0, .stmt = stmt});
+	end_range(declaration);
+}
+
+void SemanticAnalyzer::analyze_function_declaration_statement(FunctionDeclarationStatement* stmt) {
+	if (!stmt->type_params.empty()) return declare_generic(stmt);
+
+	const Token& name{stmt->identifier->identifier};
+	uint32_t declaration{record({.kind = CheckKind::DECLARATION, .defined = env_stack.has_identifier(name), .end = 0, .expr = stmt->identifier})};
+
+	if (names_parameter(stmt->return_type)) {
+		semantic_error(name, "Type not defined.");
+		stmt->return_type = nullptr;
+	}
+	if (stmt->return_type == nullptr) {
+		stmt->return_type = unifier.fresh_type_variable();
+	}
+	slot(&stmt->return_type);
+
+	for (auto& param : stmt->params) {
+		if (names_parameter(param.first)) {
+			semantic_error(param.second, "Type not defined.");
+			param.first = nullptr;
+		}
+		if (param.first == nullptr) {
+			param.first = unifier.fresh_type_variable();
+		}
+		slot(&param.first, &name, SlotMessage::PARAMETER);
+	}
+
+	uint32_t outer_floor{env_stack.enter_function()};
+	record({.kind = CheckKind::ENTER_FUNCTION, .end = 0, .expr = nullptr});
+	analyze_block_expression(stmt->block, stmt);
+	env_stack.leave_function(outer_floor);
+	record({.kind = CheckKind::LEAVE_FUNCTION, .end = 0, .expr = nullptr});
+
+	unifier.constrain(stmt->return_type, stmt->block->type);
+
+	env_stack.declare(function_of(stmt));
+
+	slot(&stmt->return_type, &name, SlotMessage::FUNCTION);
+	record({.kind = CheckKind::FUNCTION, .end = 0, .stmt = stmt});
+	end_range(declaration);
+}
+
+// Only declares the generic; its instances are what gets analyzed.
+void SemanticAnalyzer::declare_generic(FunctionDeclarationStatement* stmt) {
+	const Token& name{stmt->identifier->identifier};
+	uint32_t declaration{record({.kind = CheckKind::DECLARATION, .defined = env_stack.has_identifier(name), .end = 0, .expr = stmt->identifier})};
+
+	// Instances are analyzed after their callers, too late for a parameter to learn its type from them.
+	for (const auto& param : stmt->params) {
+		if (param.first == nullptr) semantic_error(param.second, "Parameters of a generic function need a type.");
+	}
+
+	env_stack.declare(function_of(stmt));
+	record({.kind = CheckKind::FUNCTION, .end = 0, .stmt = stmt});
+	end_range(declaration);
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Arena.h"
+#include "Environment.h"
+#include "Monomorphizer.h"
+#include "Syntax.h"
+#include "Types.h"
+#include "TypeUnifier.h"
+
+// Type inference and the semantic checks in one walk over the tree. The
+// walk resolves names and collects type constraints, and records each type
+// slot and each check in the order their diagnostics are reported: every
+// inference error comes before any check error. infer() solves each top-level
+// statement as the walk leaves it, substitutes the slots that settles and
+// the rest at the end; check() runs the checks front to back.
+//
+// Generic functions are not analyzed where they are declared. Each call
+// to one instantiates its signature with fresh type variables, and once
+// its statement is solved the call gets the instance for the inferred
+// type arguments. A new instance is analyzed like a top-level function
+// right after that statement, so it sees the top level as it stands there.
+class SemanticAnalyzer {
+public:
+	// Generic instances deeper than this are taken for runaway recursion.
+	static constexpr uint32_t MAX_INSTANTIATION_DEPTH{64};
+
+	// Instances of generic functions are allocated in `arena`.
+	SemanticAnalyzer(std::span<Statement* const> stmts, Arena& arena)
+		: stmts{stmts}, arena{arena}, monomorphizer{arena} { }
+
+	// Whether every type could be inferred.
+	bool infer();
+	// Whether the program passes the checks; only meaningful after infer()
+	// succeeded. On success, calls to generics are pointed at their instances.
+	bool check();
+
+	// The statements to generate: the program's, with each instance placed
+	// before the first statement or instance that calls it.
+	std::vector<Statement*> program() const;
+
+private:
+	enum class SlotKind : uint8_t {
+		TYPE,
+		// A block's returns must agree; if not, its own slot is skipped.
+		RETURNS,
+	};
+
+	enum class SlotMessage : uint8_t {
+		NONE,
+		IDENTIFIER,
+		LITERAL,
+		UNARY,
+		BINARY,
+		BLOCK,
+		CALL,
+		ARGUMENT,
+		RETURN,
+		VARIABLE,
+		PARAMETER,
+		FUNCTION,
+	};
+
+	// A type to substitute in place, reported with `message` at `token` if
+	// that leaves it uninferred. RETURNS slots name `count` of `returns`
+	// from `first` instead. Kept small, as there is one per typed node.
+	struct Slot {
+		SlotKind kind{};
+		SlotMessage message{};
+		uint32_t first{};
+		const Token* token{};
+		union {
+			Type* type{};
+			uint32_t count;
+		};
+	};
+
+	enum class CheckKind : uint8_t {
+		PUSH,
+		POP,
+		ENTER_FUNCTION,
+		LEAVE_FUNCTION,
+		PARAMETER,
+		IDENTIFIER,
+		GROUPING,
+		UNARY,
+		BINARY,
+		CALL,
+		ARGUMENT,
+		ARGUMENT_TYPE,
+		DECLARATION,
+		VARIABLE,
+		FUNCTION,
+	};
+
+	// One step of checking. DECLARATION and ARGUMENT skip to
+	// `end` when they fail; `index` is an argument or parameter number.
+	struct Check {
+		CheckKind kind{};
+		bool defined{};
+		uint32_t index{};
+		union {
+			uint32_t end{};
+			Type param;
+		};
+		union {
+			Expression* expr{};
+			Statement* stmt;
+		};
+	};
+
+	// A call to a generic function whose type arguments are not inferred yet.
+	struct Instantiation {
+		CallExpression* call{};
+		FunctionDeclarationStatement* generic{};
+		std::vector<Type> args{};
+		// The top-level statement or instance the call is in, and its depth.
+		Statement* caller{};
+		uint32_t depth{};
+	};
+
+	std::span<Statement* const> stmts{};
+	Arena& arena;
+
+	TypeUnifier unifier{};
+	EnvironmentStack env_stack{};
+
+	// Deques, so growing to one record per node never copies the records.
+	std::deque<Slot> slots{};
+	std::deque<Check> checks{};
+	std::vector<ReturnExpression*> returns{};
+	// Off inside casts, which are not checked.
+	bool checking{true};
+
+	// Until a check fails, every lookup the checks make finds what the
+	// walk found, so they only rebuild their environment after the first
+	// failure.
+	std::optional<EnvironmentStack> environment{};
+	std::vector<uint32_t> floors{};
+
+	Monomorphizer monomorphizer;
+	std::vector<Instantiation> pending{};
+	// New instances still to analyze, with their depth.
+	std::vector<std::pair<FunctionDeclarationStatement*, uint32_t>> queued{};
+	// Calls to instances not analyzed yet, whose types join the instance's
+	// return type once it is inferred.
+	std::unordered_map<const Statement*, std::vector<CallExpression*>> awaiting_return{};
+	std::vector<std::pair<CallExpression*, FunctionDeclarationStatement*>> instance_calls{};
+	std::unordered_map<const Statement*, std::vector<FunctionDeclarationStatement*>> called_instances{};
+	Statement* caller{};
+	uint32_t depth{};
+
+	bool success{true};
+
+	void semantic_error(const Token& token, const std::string& message);
+
+	void slot(Type* type, const Token* token = nullptr, SlotMessage message = SlotMessage::NONE) {
+		slots.push_back({.kind = SlotKind::TYPE, .message = message, .token = token, .type = type});
+	}
+	uint32_t record(const Check& check) {
+		if (checking) checks.push_back(check);
+		return (uint32_t)checks.size() - 1;
+	}
+	void end_range(uint32_t check) {
+		if (checking) checks[check].end = (uint32_t)checks.size();
+	}
+
+	void infer_statement(Statement* stmt, uint32_t depth);
+	void instantiate();
+	void place(Statement* stmt, std::vector<Statement*>& ordered, std::unordered_set<const Statement*>& placed) const;
+	void settle(Statement* stmt, size_t first_slot, size_t first_return, size_t first_check);
+	void substitute_slots();
+	void fail(size_t at);
+	void replay_environment(size_t at);
+	void apply_scope(const Check& check);
+	void run_check(size_t& i);
+
+	void analyze_expression(Expression* expr);
+	void resolve_identifier(IdentifierExpression* expr);
+	void analyze_identifier_expression(IdentifierExpression* expr);
+	void analyze_literal_expression(LiteralExpression* expr);
+	void analyze_grouping_expression(GroupingExpression* expr);
+	void analyze_unary_expression(UnaryExpression* expr);
+	void analyze_binary_expression(BinaryExpression* expr);
+	void analyze_block_expression(BlockExpression* expr, FunctionDeclarationStatement* func = nullptr);
+	void analyze_call_expression(CallExpression* expr);
+	void analyze_arguments(CallExpression* expr, const Function* func, std::span<const Type> type_args);
+	void analyze_return_expression(ReturnExpression* expr);
+	void analyze_cast_expression(CastExpression* expr);
+
+	void analyze_statement(Statement* stmt);
+	void analyze_variable_declaration_statement(VariableDeclarationStatement* stmt);
+	void analyze_function_declaration_statement(FunctionDeclarationStatement* stmt);
+	void declare_generic(FunctionDeclarationStatement* stmt);
+};
@@ -0,0 +1,147 @@
+#include <optional>
+#include "SemanticChecks.h"
+#include "ErrorHandling.h"
+#include "Lexer.h"
+
+static std::optional<TConstructor> con(const Type& type) noexcept {
+	if (auto c{type_cast<TConstructor>(type)}) {
+		return *c;
+	} else {
+		return std::nullopt;
+	}
+}
+
+bool check_unary(UnaryExpression* expr) {
+	TConstructor expr_type{con(expr->expr->type).value_or(TConstructor{})};
+
+	switch (expr->op.type) {
+		case TokenType::NOT:
+			if (is_pointer(expr->expr->type)) {
+				error(expr->op, "Incorrect type. Cannot be a pointer.");
+				return false;
+			}
+			if (expr_type != types.at(TypeEnum::BOOL)) {
+				error(expr->op, "Incorrect type. Must be a bool."); 
+				return false;
+			}
+			break;
+		case TokenType::MINUS:
+			if (is_pointer(expr->expr->type)) {
+				error(expr->op, "Incorrect type. Cannot be a pointer.");
+				return false;
+			}
+			if (!is_number_type(expr_type.type)) {
+				error(expr->op, "Incorrect type. Must be an number.");
+				return false;
+			}
+			break;
+		case TokenType::AMPERSAND:
+			if (auto lit{node_cast<LiteralExpression>(expr->expr)}) {
+				error(lit->value, "Cannot dereference literal.");
+				return false;
+			}
+			if (expr_type == types.at(TypeEnum::NONE)) {
+				error(expr->op, "Incorrect type. Cannot dereference a none type.");
+				return false;
+			}
+			break;
+		case TokenType::STAR:
+			expr->lvalue = true;
+			if (!is_pointer(expr->expr->type)) {
+				error(expr->op, "Can only dereference pointer.");
+				return false;
+			}
+			break;
+		default:
+			error(expr->op, "Unknown expression operator.");
+			return false;
+	}
+	return true;
+}
+
+bool check_binary(BinaryExpression* expr) {
+	if (con(expr->sides.first->type) != con(expr->sides.second->type)) {
+		error(expr->op, "Mismatched types in binary expression.");
+		return false;
+	}
+
+	TConstructor lhs_type{con(expr->sides.first->type).value_or(TConstructor{})};
+	TConstructor rhs_type{con(expr->sides.second->type).value_or(TConstructor{})};
+
+	switch (expr->op.type) {
+		case TokenType::PLUS:
+		case TokenType::MINUS:
+		case TokenType::STAR:
+		case TokenType::SLASH:
+			if (!is_number_type(lhs_type.type) ||
+				!is_number_type(rhs_type.type)) {
+				error(expr->op, "Incorrect type. Must be an number.");
+				return false;
+			}
+			return true;
+		case TokenType::GREATER:
+		case TokenType::GREATER_EQUAL:
+		case TokenType::LESS:
+		case TokenType::LESS_EQUAL:
+			if (is_number_type(lhs_type.type) ||
+				is_number_type(rhs_type.type)) {
+				error(expr->op, "Incorrect type. Must be a bool or number.");
+				return false;
+			}
+			return true;
+		case TokenType::NOT_EQUAL:
+		case TokenType::EQUAL_EQUAL:
+			if (is_number_type(lhs_type.type) ||
+				lhs_type != types.at(TypeEnum::BOOL)) {
+				error(expr->op, "Incorrect type. Must be a bool or number.");
+				return false;
+			}
+			return true;
+		case TokenType::AND:
+		case TokenType::OR:
+			if (lhs_type != types.at(TypeEnum::BOOL) ||
+				rhs_type != types.at(TypeEnum::BOOL)) {
+				error(expr->op, "Incorrect type. Must be a bool.");
+				return false;
+			}
+			return true;
+		case TokenType::EQUAL: {
+			if (!expr->sides.first->lvalue) {
+				error(expr->op, "LHS must be a lvalue.");
+				return false;
+			}
+
+			if (lhs_type != rhs_type) {
+				error(expr->op, "Incorrect type. RHS must equal LHS.");
+				return false;
+			}
+
+			expr->lvalue = true;
+
+			return true;
+		}
+		default:
+			error(expr->op, "Unknown binary operator.");
+			return false;
+	}
+}
+
+bool check_variable_declaration(VariableDeclarationStatement* stmt) {
+	if (stmt->type == Type::of(TypeEnum::NONE)) {
+		error(stmt->identifier->identifier, "Cannot declare variable of type none.");
+		return false;
+	}
+	if (stmt->initializer->type != stmt->type) {
+		error(stmt->identifier->identifier, "Incorrect type.");
+		return false;
+	}
+	return true;
+}
+
+bool check_function_declaration(FunctionDeclarationStatement* stmt) {
+	if (stmt->block->type != stmt->return_type) {
+		error(stmt->identifier->identifier, "Block is not the same type as specified function return type.");
+		return false;
+	}
+	return true;
+}
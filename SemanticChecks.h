@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Syntax.h"
+#include "Types.h"
+
+// The checks on one node whose children have been typed and checked. Each
+// reports its own error and returns false on the first problem it finds.
+bool check_unary(UnaryExpression* expr);
+bool check_binary(BinaryExpression* expr);
+bool check_variable_declaration(VariableDeclarationStatement* stmt);
+bool check_function_declaration(FunctionDeclarationStatement* stmt);
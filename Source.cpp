@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Source.h"
+
+void SourceMap::reset(std::string_view text) {
+	SourceMap::text = text;
+	line_starts.clear();
+}
+
+void SourceMap::index() {
+	if (!line_starts.empty()) return;
+	line_starts.push_back(0u);
+	for (uint32_t i{0}; i < text.size(); i++) {
+		if (text[i] == '\n') line_starts.push_back(i + 1);
+	}
+}
+
+SourceMap::Position SourceMap::locate(const char* at) {
+	if (text.data() == nullptr || !contains(at)) return {};
+
+	index();
+
+	uint32_t offset{(uint32_t)(at - text.data())};
+	auto next_line{std::ranges::upper_bound(line_starts, offset)};
+	unsigned int line{(unsigned int)(next_line - line_starts.begin())};
+	return {line, offset - *(next_line - 1) + 1};
+}
+
+SourceFile::SourceFile(const std::string& path) {
+	int fd{path == "-" ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY)};
+	if (fd < 0) return;
+
+	struct stat st{};
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		void* addr{mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)};
+		if (addr != MAP_FAILED) {
+			madvise(addr, st.st_size, MADV_SEQUENTIAL);
+			mapping = addr;
+			mapping_size = st.st_size;
+			text = {(const char*)addr, mapping_size};
+			open = true;
+		}
+	}
+
+	if (!open) {
+		open = read_all(fd);
+		text = buffer;
+	}
+
+	if (fd != STDIN_FILENO) close(fd);
+}
+
+SourceFile::~SourceFile() {
+	if (mapping != nullptr) munmap(mapping, mapping_size);
+}
+
+bool SourceFile::read_all(int fd) {
+	constexpr size_t CHUNK{1u << 16};
+	for (;;) {
+		size_t size{buffer.size()};
+		buffer.resize(size + CHUNK);
+		ssize_t n{read(fd, buffer.data() + size, CHUNK)};
+		if (n < 0) {
+			buffer.clear();
+			return false;
+		}
+		buffer.resize(size + n);
+		if (n == 0) return true;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+// Tokens only remember where their text starts, so line numbers are
+// recovered here on demand. The line index is built the first time a
+// diagnostic (or the token dump) asks for a position.
+class SourceMap {
+public:
+	struct Position {
+		unsigned int line{};
+		unsigned int column{};
+	};
+
+	static void reset(std::string_view text);
+
+	static bool contains(const char* at) noexcept {
+		return at >= text.data() && at <= text.data() + text.size();
+	}
+
+	// Builds the line index now rather than on the first lookup, so that
+	// several threads can locate tokens at once afterwards.
+	static void index();
+
+	static Position locate(const char* at);
+	static unsigned int line_of(const char* at) { return locate(at).line; }
+
+private:
+	static inline std::string_view text{};
+	static inline std::vector<uint32_t> line_starts{};
+};
+
+// Read-only view of a source file for the whole pipeline. Regular files
+// are mapped and lexed in place; pipes and stdin ("-") are read once into
+// an owned buffer.
+class SourceFile {
+public:
+	explicit SourceFile(const std::string& path);
+	~SourceFile();
+
+	SourceFile(const SourceFile&) = delete;
+	SourceFile& operator=(const SourceFile&) = delete;
+
+	bool is_open() const noexcept { return open; }
+	std::string_view view() const noexcept { return text; }
+
+private:
+	std::string_view text{};
+	std::string buffer{};
+	void* mapping{};
+	size_t mapping_size{};
+	bool open{};
+
+	bool read_all(int fd);
+};
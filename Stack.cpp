@@ -0,0 +1,108 @@
+// Darwin only declares the ucontext routines for X/Open, and keeps MAP_ANON
+// and the _np stack queries behind _DARWIN_C_SOURCE once that is set.
+#ifdef __APPLE__
+#define _XOPEN_SOURCE 700
+#define _DARWIN_C_SOURCE
+#endif
+
+#include <exception>
+#include <new>
+#include <vector>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include "Stack.h"
+
+#ifndef MAP_STACK
+#define MAP_STACK 0
+#endif
+
+namespace {
+
+struct StackCall {
+	void (*fn)(void*);
+	void* arg;
+	std::exception_ptr exception{};
+	ucontext_t caller{};
+};
+
+thread_local const char* limit{nullptr};
+thread_local StackCall* starting_call{nullptr};
+// Segments released by finished calls, kept so that a pass hovering around
+// a segment boundary does not map and unmap one per node.
+thread_local std::vector<char*> spare_segments{};
+
+const char* thread_stack_limit() noexcept {
+#ifdef __APPLE__
+	// Darwin reports the top of the stack, which grows down from it.
+	pthread_t self{pthread_self()};
+	return (const char*)pthread_get_stackaddr_np(self) - pthread_get_stacksize_np(self);
+#else
+	pthread_attr_t attr{};
+	void* addr{nullptr};
+	size_t size{0};
+	if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+		pthread_attr_getstack(&attr, &addr, &size);
+		pthread_attr_destroy(&attr);
+	}
+	return (const char*)addr;
+#endif
+}
+
+char* take_segment() {
+	if (!spare_segments.empty()) {
+		char* segment{spare_segments.back()};
+		spare_segments.pop_back();
+		return segment;
+	}
+	void* segment{mmap(nullptr, STACK_SEGMENT_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0)};
+	if (segment == MAP_FAILED) throw std::bad_alloc{};
+	return (char*)segment;
+}
+
+void give_back_segment(char* segment) {
+	if (spare_segments.size() < 2) {
+		spare_segments.push_back(segment);
+	} else {
+		munmap(segment, STACK_SEGMENT_SIZE);
+	}
+}
+
+void start_call() {
+	StackCall* call{starting_call};
+	try {
+		call->fn(call->arg);
+	} catch (...) {
+		call->exception = std::current_exception();
+	}
+	// Returning resumes uc_link, i.e. the caller's context.
+}
+
+}
+
+const char* stack_limit() noexcept {
+	if (limit == nullptr) limit = thread_stack_limit();
+	return limit;
+}
+
+void run_on_new_stack(void (*fn)(void*), void* arg) {
+	char* segment{take_segment()};
+	StackCall call{fn, arg};
+
+	ucontext_t callee{};
+	getcontext(&callee);
+	callee.uc_stack.ss_sp = segment;
+	callee.uc_stack.ss_size = STACK_SEGMENT_SIZE;
+	callee.uc_link = &call.caller;
+	makecontext(&callee, start_call, 0);
+
+	const char* outer_limit{stack_limit()};
+	limit = segment;
+	starting_call = &call;
+	swapcontext(&call.caller, &callee);
+	limit = outer_limit;
+
+	give_back_segment(segment);
+	if (call.exception) std::rethrow_exception(call.exception);
+}
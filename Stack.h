@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// Deeply nested programs recurse once per nesting level in every pass. The
+// recursive entry points check stack_exhausted() and, when it is set, carry
+// on through on_new_stack(), which runs the call on a fresh heap segment and
+// switches back when it returns. Depth is then bounded by memory rather than
+// by the thread's stack size.
+inline constexpr size_t STACK_RED_ZONE{256 * 1024};
+inline constexpr size_t STACK_SEGMENT_SIZE{8 * 1024 * 1024};
+
+// Lowest usable address of the stack (or segment) the thread is running on.
+const char* stack_limit() noexcept;
+
+// Runs fn(arg) on a new segment. Exceptions thrown by fn are rethrown here.
+void run_on_new_stack(void (*fn)(void*), void* arg);
+
+inline bool stack_exhausted() noexcept {
+	const char* frame{(const char*)__builtin_frame_address(0)};
+	return (size_t)(frame - stack_limit()) < STACK_RED_ZONE;
+}
+
+template <typename F>
+std::invoke_result_t<F&> on_new_stack(F&& f) {
+	using R = std::invoke_result_t<F&>;
+	if constexpr (std::is_void_v<R>) {
+		run_on_new_stack([](void* p) { (*(std::remove_reference_t<F>*)p)(); }, &f);
+	} else {
+		std::optional<R> result{};
+		auto call{[&] { result.emplace(f()); }};
+		run_on_new_stack([](void* p) { (*(decltype(call)*)p)(); }, &call);
+		return std::move(*result);
+	}
+}
@@ -0,0 +1,29 @@
+#include <mutex>
+#include <stdexcept>
+#include "Symbol.h"
+
+Symbol SymbolTable::intern(std::string_view name) {
+	{
+		std::shared_lock lock{mutex};
+		if (auto it{ids.find(name)}; it != ids.end()) return it->second;
+	}
+
+	std::unique_lock lock{mutex};
+	if (auto it{ids.find(name)}; it != ids.end()) return it->second;
+	if (names.size() >= MAX_SYMBOLS) throw std::length_error{"Too many distinct identifiers."};
+
+	Symbol symbol{(Symbol)names.size()};
+	ids.emplace(names.emplace_back(name), symbol);
+	return symbol;
+}
+
+std::string_view SymbolTable::name(Symbol symbol) const {
+	std::shared_lock lock{mutex};
+	return names[symbol];
+}
+
+SymbolTable& symbols() {
+	// Function-local, so NATIVE_FUNCTIONS can intern during static initialization.
+	static SymbolTable table{};
+	return table;
+}
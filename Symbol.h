@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Dense id of an interned identifier. The Lexer interns every identifier
+// once, so the later passes compare and hash names as integers. Symbol 0 is
+// the empty name, carried by every token that is not an identifier.
+using Symbol = uint32_t;
+
+class SymbolTable {
+public:
+	// Ids have to fit in the 24 bits a Token keeps for them.
+	static constexpr Symbol MAX_SYMBOLS{1u << 24};
+
+	Symbol intern(std::string_view name);
+	std::string_view name(Symbol symbol) const;
+
+private:
+	// ParallelParser workers intern concurrently; most lookups only read.
+	mutable std::shared_mutex mutex{};
+	std::deque<std::string> names{std::string{}};
+	std::unordered_map<std::string_view, Symbol> ids{{names.front(), 0}};
+};
+
+// The table shared by every pass.
+SymbolTable& symbols();
+
+inline Symbol intern(std::string_view name) { return symbols().intern(name); }
+inline std::string_view symbol_name(Symbol symbol) { return symbols().name(symbol); }
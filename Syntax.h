@@ -1,122 +1,235 @@
 #pragma once
 
+#include <cstdint>
 #include <utility>
 #include <memory>
 #include <variant>
 #include <iostream>
+#include <span>
+#include "Arena.h"
 #include "Types.h"
 
+// Node kinds, so passes can dispatch on a tag with visit() below instead of
+// trying casts one type at a time.
+enum class ExpressionKind : uint8_t {
+	IDENTIFIER,
+	LITERAL,
+	GROUPING,
+	UNARY,
+	BINARY,
+	BLOCK,
+	CALL,
+	RETURN,
+	CAST,
+};
+
+enum class StatementKind : uint8_t {
+	EXPRESSION,
+	VARIABLE_DECLARATION,
+	FUNCTION_DECLARATION,
+};
+
+// What calling a function may do, from least to most. A pure call only
+// computes from its arguments; a read-only one may also read memory the
+// caller can see; an effectful one may write it, do I/O, trap or never
+// return.
+enum class Effect : uint8_t {
+	PURE,
+	READ_ONLY,
+	EFFECTFUL,
+};
+
 struct Expression {
+	explicit Expression(ExpressionKind kind) : kind{kind} { }
 	virtual ~Expression() = default;
 
 	virtual void print() { type->print(); }
 
+	const ExpressionKind kind;
 	Type type{};
 	bool lvalue{};
 };
 
 struct UnaryExpression : public Expression {
-	explicit UnaryExpression(const Token& op, std::shared_ptr<Expression>& expr)
-		: op{op}, expr{expr} { }
+	static constexpr ExpressionKind KIND{ExpressionKind::UNARY};
+
+	explicit UnaryExpression(const Token& op, Expression* expr)
+		: Expression{KIND}, op{op}, expr{expr} { }
 	
 	Token op{};
-	std::shared_ptr<Expression> expr{};
+	Expression* expr{};
 };
 
 struct BinaryExpression : public Expression {
-	explicit BinaryExpression(std::shared_ptr<Expression>& lhs, const Token& op, std::shared_ptr<Expression>& rhs)
-		: sides{std::make_pair(lhs, rhs)}, op{op} { }
+	static constexpr ExpressionKind KIND{ExpressionKind::BINARY};
+
+	explicit BinaryExpression(Expression* lhs, const Token& op, Expression* rhs)
+		: Expression{KIND}, sides{lhs, rhs}, op{op} { }
 
-	std::pair<std::shared_ptr<Expression>, std::shared_ptr<Expression>> sides{};
+	std::pair<Expression*, Expression*> sides{};
 	Token op{};
 };
 
 struct GroupingExpression : public Expression {
-	explicit GroupingExpression(std::shared_ptr<Expression>& expr)
-		: expr{std::move(expr)} { }
+	static constexpr ExpressionKind KIND{ExpressionKind::GROUPING};
+
+	explicit GroupingExpression(Expression* expr)
+		: Expression{KIND}, expr{expr} { }
 
-	std::shared_ptr<Expression> expr{};
+	Expression* expr{};
 };
 
 struct LiteralExpression : public Expression {
+	static constexpr ExpressionKind KIND{ExpressionKind::LITERAL};
+
 	explicit LiteralExpression(const Token& value)
-		: value{value} { }
+		: Expression{KIND}, value{value} { }
 
 	Token value{};
 };
 
 struct IdentifierExpression : public Expression {
+	static constexpr ExpressionKind KIND{ExpressionKind::IDENTIFIER};
+
 	explicit IdentifierExpression(const Token& identifier)
-		: identifier{identifier} { }
+		: Expression{KIND}, identifier{identifier} { }
 	
 	Token identifier{};
 };
 
 struct CallExpression : public Expression {
-	explicit CallExpression(const std::shared_ptr<Expression>& callee,
-		const Token& closing_paren, const std::vector<std::shared_ptr<Expression>>& args)
-		: callee{callee}, closing_paren{closing_paren}, args{args} { }
+	static constexpr ExpressionKind KIND{ExpressionKind::CALL};
+
+	explicit CallExpression(Expression* callee,
+		const Token& closing_paren, std::span<Expression*> args)
+		: Expression{KIND}, callee{callee}, closing_paren{closing_paren}, args{args} { }
 
-	std::shared_ptr<Expression> callee{};
+	Expression* callee{};
 	Token closing_paren{};
-	std::vector<std::shared_ptr<Expression>> args{};
+	std::span<Expression*> args{};
 };
 
 struct ReturnExpression : public Expression {
-	explicit ReturnExpression (const Token& return_token, const std::shared_ptr<Expression>& return_expression)
-	: return_tok{return_token}, return_expression{return_expression} { }
+	static constexpr ExpressionKind KIND{ExpressionKind::RETURN};
+
+	explicit ReturnExpression (const Token& return_token, Expression* return_expression)
+	: Expression{KIND}, return_tok{return_token}, return_expression{return_expression} { }
 
 	Token return_tok{};
-	std::shared_ptr<Expression> return_expression{};
+	Expression* return_expression{};
 };
 
 struct Statement {
+	explicit Statement(StatementKind kind) : kind{kind} { }
 	virtual ~Statement() = default;
+
+	const StatementKind kind;
 };
 
 struct BlockExpression : public Expression {
-	explicit BlockExpression(const std::vector<std::shared_ptr<Statement>>& statements,
-		const Token& opening_block) : statements{statements}, opening_block{opening_block} { }
+	static constexpr ExpressionKind KIND{ExpressionKind::BLOCK};
+
+	explicit BlockExpression(std::span<Statement*> statements,
+		const Token& opening_block) : Expression{KIND}, statements{statements}, opening_block{opening_block} { }
 	
-	std::vector<std::shared_ptr<Statement>> statements{};
+	std::span<Statement*> statements{};
 	Token opening_block{};
 };
 
 struct CastExpression : public Expression {
-	explicit CastExpression(const std::shared_ptr<Expression>& expr, const Token& as, const Type& cast_type)
-		: expr{expr}, as{as}, cast_type{cast_type} { }
+	static constexpr ExpressionKind KIND{ExpressionKind::CAST};
+
+	explicit CastExpression(Expression* expr, const Token& as, const Type& cast_type)
+		: Expression{KIND}, expr{expr}, as{as}, cast_type{cast_type} { }
 	
-	std::shared_ptr<Expression> expr{};
+	Expression* expr{};
 	Token as{};
 	Type cast_type{};
 };
 
 struct ExpressionStatement : public Statement {
-	explicit ExpressionStatement(const std::shared_ptr<Expression>& expr)
-		: expr{expr} { }
+	static constexpr StatementKind KIND{StatementKind::EXPRESSION};
+
+	explicit ExpressionStatement(Expression* expr)
+		: Statement{KIND}, expr{expr} { }
 	
-	std::shared_ptr<Expression> expr{};
+	Expression* expr{};
 };
 
 struct VariableDeclarationStatement : public Statement {
-	explicit VariableDeclarationStatement(const Type& type, const std::shared_ptr<IdentifierExpression>& identifier, const std::shared_ptr<Expression>& initializer)
-		: type{type}, identifier{identifier}, initializer{initializer} { }
+	static constexpr StatementKind KIND{StatementKind::VARIABLE_DECLARATION};
+
+	explicit VariableDeclarationStatement(const Type& type, IdentifierExpression* identifier, Expression* initializer)
+		: Statement{KIND}, type{type}, identifier{identifier}, initializer{initializer} { }
 
 	Type type{};
-	std::shared_ptr<IdentifierExpression> identifier{};
-	std::shared_ptr<Expression> initializer{};
+	IdentifierExpression* identifier{};
+	Expression* initializer{};
 };
 
 struct FunctionDeclarationStatement : public Statement {
+	static constexpr StatementKind KIND{StatementKind::FUNCTION_DECLARATION};
+
 	explicit FunctionDeclarationStatement(const Type& return_type,
-		const std::shared_ptr<IdentifierExpression>& identifier,
-		const std::vector<std::pair<Type, Token>>& params,
-		const std::shared_ptr<BlockExpression>& block)
-		: return_type{return_type}, identifier{identifier}, params{params}, block{block} { }
+		IdentifierExpression* identifier,
+		std::vector<std::pair<Type, Token>> params,
+		BlockExpression* block,
+		std::vector<Token> type_params = {})
+		: Statement{KIND}, return_type{return_type}, identifier{identifier}, params{std::move(params)}, block{block},
+		type_params{std::move(type_params)} { }
 
 	Type return_type{};
-	std::shared_ptr<IdentifierExpression> identifier{};
+	IdentifierExpression* identifier{};
 	std::vector<std::pair<Type, Token>> params{};
-	std::shared_ptr<BlockExpression> block{};
+	BlockExpression* block{};
+
+	// Empty unless the function is generic. A generic is never analyzed or
+	// generated itself, only its instances are.
+	std::vector<Token> type_params{};
+	// For an instance, the generic it was made from and its type arguments.
+	FunctionDeclarationStatement* generic{};
+	std::vector<Type> type_args{};
+
+	// Set by EffectAnalyzer.
+	Effect effect{Effect::EFFECTFUL};
 };
 
+
+// The node as a T if it is one, like dynamic_cast but by comparing tags.
+template <typename T, typename Node>
+T* node_cast(Node* node) noexcept {
+	return node != nullptr && node->kind == T::KIND ? static_cast<T*>(node) : nullptr;
+}
+
+// Calls `f` with the node cast to its concrete type. Passes give one
+// overload per node they handle, usually through `overloaded`.
+template <typename F>
+decltype(auto) visit(Expression* expr, F&& f) {
+	switch (expr->kind) {
+		case ExpressionKind::IDENTIFIER: return f(static_cast<IdentifierExpression*>(expr));
+		case ExpressionKind::LITERAL: return f(static_cast<LiteralExpression*>(expr));
+		case ExpressionKind::GROUPING: return f(static_cast<GroupingExpression*>(expr));
+		case ExpressionKind::UNARY: return f(static_cast<UnaryExpression*>(expr));
+		case ExpressionKind::BINARY: return f(static_cast<BinaryExpression*>(expr));
+		case ExpressionKind::BLOCK: return f(static_cast<BlockExpression*>(expr));
+		case ExpressionKind::CALL: return f(static_cast<CallExpression*>(expr));
+		case ExpressionKind::RETURN: return f(static_cast<ReturnExpression*>(expr));
+		case ExpressionKind::CAST: return f(static_cast<CastExpression*>(expr));
+	}
+	std::unreachable();
+}
+
+template <typename F>
+decltype(auto) visit(Statement* stmt, F&& f) {
+	switch (stmt->kind) {
+		case StatementKind::EXPRESSION: return f(static_cast<ExpressionStatement*>(stmt));
+		case StatementKind::VARIABLE_DECLARATION: return f(static_cast<VariableDeclarationStatement*>(stmt));
+		case StatementKind::FUNCTION_DECLARATION: return f(static_cast<FunctionDeclarationStatement*>(stmt));
+	}
+	std::unreachable();
+}
+
+template <typename... Fs>
+struct overloaded : Fs... {
+	using Fs::operator()...;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <ostream>
+#include "Lexer.h"
+
+// Pulls tokens from a Lexer as the Parser asks for them. Only the previous
+// token, the current one and a little lookahead are kept, in a ring, so
+// lexing and parsing interleave and no token vector is built. References
+// returned here stay valid until the ring wraps past them, i.e. callers
+// should copy a token before peeking further ahead.
+class TokenStream {
+public:
+	static constexpr size_t MAX_LOOKAHEAD{2};
+
+	// Every token pulled from the lexer is also written to `dump`, if given.
+	explicit TokenStream(Lexer& lexer, std::ostream* dump = nullptr)
+		: lexer{lexer}, dump{dump} { }
+
+	const Token& peek(size_t ahead = 0) {
+		while (pulled <= current + ahead) pull();
+		return ring[(current + ahead) & MASK];
+	}
+	const Token& previous() const { return ring[(current - 1) & MASK]; }
+	void advance() { peek(); current++; }
+
+	// Lexes whatever the parser did not consume, so the dump and any lexer
+	// diagnostics cover the whole source.
+	void drain() {
+		while (!lexed_eof) pull();
+	}
+
+private:
+	static constexpr size_t CAPACITY{MAX_LOOKAHEAD + 2};
+	static constexpr size_t MASK{CAPACITY - 1};
+	static_assert((CAPACITY & MASK) == 0, "Ring capacity must be a power of two.");
+
+	Lexer& lexer;
+	std::ostream* dump{};
+
+	std::array<Token, CAPACITY> ring{};
+	size_t current{};
+	size_t pulled{};
+	bool lexed_eof{};
+
+	void pull() {
+		Token& tok{ring[pulled++ & MASK]};
+		tok = lexer.next();
+		if (lexed_eof) return;
+		lexed_eof = (tok.type == TokenType::END_OF_FILE);
+		if (dump != nullptr) *dump << tok << '\n';
+	}
+};
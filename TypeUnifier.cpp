@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <utility>
+#include "TypeUnifier.h"
+#include "Stack.h"
+
+uint32_t TypeUnifier::find(uint32_t var) {
+	while (classes[var].parent != var) {
+		uint32_t& parent{classes[var].parent};
+		parent = classes[parent].parent;
+		var = parent;
+	}
+	return var;
+}
+
+// The older root wins, so a class is rooted in its oldest variable and
+// closing a scope never strands a variable from before it.
+void TypeUnifier::join(uint32_t root1, uint32_t root2) {
+	if (root1 == root2) return;
+	if (root2 < root1) std::swap(root1, root2);
+	classes[root2].parent = root1;
+}
+
+void TypeUnifier::bind(uint32_t root, const Type& type) {
+	if (occurs_in(root, type)) {
+		//throw std::runtime_error("Infinite type");
+		return;
+	}
+	classes[root].bound = type;
+	if (root < scope_floor) bound_below.push_back(root);
+}
+
+void TypeUnifier::unify(const Type& t1, const Type& t2) {
+	if (stack_exhausted()) return on_new_stack([&] { return unify(t1, t2); });
+	if (auto var1{type_cast<TVariable>(t1)}) {
+		uint32_t root1{find(var1->index)};
+		if (classes[root1].bound != nullptr) return unify(classes[root1].bound, t2);
+
+		if (auto var2{type_cast<TVariable>(t2)}) {
+			uint32_t root2{find(var2->index)};
+			if (classes[root2].bound != nullptr) return bind(root1, classes[root2].bound);
+			return join(root1, root2);
+		}
+		return bind(root1, t2);
+	}
+	if (type_cast<TVariable>(t2) != nullptr) return unify(t2, t1);
+
+	auto cons1{type_cast<TConstructor>(t1)};
+	auto cons2{type_cast<TConstructor>(t2)};
+	if (cons1 && cons2) {
+		if (cons1->type != cons2->type || cons1->generics.size() != cons2->generics.size()) {
+			//throw std::runtime_error("Type mismatch");
+			return;
+		}
+		for (size_t i = 0; i < cons1->generics.size(); ++i) {
+			unify(cons1->generics[i], cons2->generics[i]);
+		}
+		return;
+	}
+
+	auto p1{type_cast<TPointer>(t1)};
+	auto p2{type_cast<TPointer>(t2)};
+	if (p1 && p2) {
+		unify(p1->inner, p2->inner);
+		return;
+	}
+	
+	//throw std::runtime_error("Unification failed");
+}
+
+// Only reached when binding an unknown class, so only the unknown
+// variables inside `t` can close a cycle.
+bool TypeUnifier::occurs_in(uint32_t root, const Type& t) {
+	if (stack_exhausted()) return on_new_stack([&] { return occurs_in(root, t); });
+	if (auto var{type_cast<TVariable>(t)}) {
+		uint32_t other{find(var->index)};
+		if (other == root) return true;
+		return (classes[other].bound != nullptr && occurs_in(root, classes[other].bound));
+	} else if (auto cons{type_cast<TConstructor>(t)}) {
+		return std::ranges::any_of(cons->generics, [&](const Type& sub) { return occurs_in(root, sub); });
+	} else if (auto ptr{type_cast<TPointer>(t)}) {
+		return occurs_in(root, ptr->inner);
+	}
+	return false;
+}
+
+// Gives back `t` itself when nothing in it is bound. A variable still
+// unknown comes back as its class's root.
+Type TypeUnifier::substitute(const Type& t) {
+	if (stack_exhausted()) return on_new_stack([&] { return substitute(t); });
+	if (auto var{type_cast<TVariable>(t)}) {
+		uint32_t index{find(var->index)};
+		TypeClass& root{classes[index]};
+		if (root.bound == nullptr) return (index == var->index ? t : Type::variable(index));
+		// Store the finished type, so the rest of the class resolves at once.
+		root.bound = substitute(root.bound);
+		return root.bound;
+	} else if (auto cons{type_cast<TConstructor>(t)}) {
+		if (cons->generics.empty()) return t;
+		std::vector<Type> generics{};
+		bool changed{false};
+		for (const Type& sub : cons->generics) {
+			generics.push_back(substitute(sub));
+			changed |= (generics.back() != sub);
+		}
+		if (!changed) return t;
+		return Type::constructor(cons->type, generics);
+	} else if (auto ptr{type_cast<TPointer>(t)}) {
+		Type inner{substitute(ptr->inner)};
+		if (inner == ptr->inner) return t;
+		return Type::pointer_to(inner);
+	}
+	return t;
+}
+
+void TypeUnifier::solve() {
+	for (const CEquality& eq : type_constraints) {
+		unify(eq.t1, eq.t2);
+	}
+	type_constraints.clear();
+}
+
+void TypeUnifier::open_scope() {
+	scope_floor = (uint32_t)classes.size();
+	retained_end = scope_floor;
+}
+
+void TypeUnifier::retain(const Type& t) {
+	if (stack_exhausted()) return on_new_stack([&] { return retain(t); });
+	if (auto var{type_cast<TVariable>(t)}) {
+		// The path to the root only goes to older variables, which stay too.
+		retained_end = std::max(retained_end, var->index + 1);
+		TypeClass& root{classes[find(var->index)]};
+		if (root.bound != nullptr) {
+			root.bound = substitute(root.bound);
+			retain(root.bound);
+		}
+	} else if (auto cons{type_cast<TConstructor>(t)}) {
+		for (const Type& sub : cons->generics) retain(sub);
+	} else if (auto ptr{type_cast<TPointer>(t)}) {
+		retain(ptr->inner);
+	}
+}
+
+void TypeUnifier::close_scope() {
+	for (uint32_t root : bound_below) {
+		retain(Type::variable(root));
+	}
+	bound_below.clear();
+	classes.resize(retained_end);
+	scope_floor = 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "Types.h"
+
+struct Constraint {
+	virtual ~Constraint() = default;
+};
+
+struct CEquality : public Constraint {
+	CEquality() : Constraint{} { }
+	explicit CEquality(const Type& t1, const Type& t2) : Constraint{}, t1{t1}, t2{t2} { }
+	Type t1{};
+	Type t2{};
+};
+
+static bool is_inferred(const Type& t) {
+	if (type_cast<TConstructor>(t) != nullptr) return true;
+	if (auto p{type_cast<TPointer>(t)}) return is_inferred(p->inner);
+	return false;
+}
+
+// No type variable anywhere in it, so substituting it again changes nothing.
+static bool is_ground(const Type& t) {
+	if (auto cons{type_cast<TConstructor>(t)}) return std::ranges::all_of(cons->generics, is_ground);
+	if (auto p{type_cast<TPointer>(t)}) return is_ground(p->inner);
+	return false;
+}
+
+// Collects equality constraints between types and solves them. Type
+// variables that have been unified form one class in a union-find forest.
+// Only a class's root says what the class is bound to: a non-variable
+// type, or null while it is still unknown.
+//
+// Variables can be scoped, to a function say. When the scope closes its
+// constraints are solved and its variables dropped, except those that a
+// type retained past the scope still names, so memory follows the largest
+// scope rather than the whole program.
+class TypeUnifier {
+public:
+	Type fresh_type_variable() {
+		classes.push_back({(uint32_t)classes.size()});
+		return Type::variable((uint32_t)classes.size() - 1);
+	}
+
+	void constrain(const Type& t1, const Type& t2) { type_constraints.emplace_back(t1, t2); }
+	void solve();
+	Type substitute(const Type& type);
+
+	// Variables made from here on belong to the scope.
+	void open_scope();
+	// Keeps the variables `t` names past the end of the scope. Only
+	// meaningful once the scope's constraints are solved.
+	void retain(const Type& t);
+	void close_scope();
+
+private:
+	struct TypeClass {
+		uint32_t parent{};
+		Type bound{};
+	};
+
+	std::vector<TypeClass> classes{};
+	std::vector<CEquality> type_constraints{};
+
+	// 0 outside a scope. Roots below the floor that the scope bound may
+	// name its variables in their bounds, so closing it settles them.
+	uint32_t scope_floor{};
+	std::vector<uint32_t> bound_below{};
+	// One past the newest variable of the scope that is retained.
+	uint32_t retained_end{};
+
+	// The root of a variable's class, compressing the path to it.
+	uint32_t find(uint32_t var);
+	void join(uint32_t root1, uint32_t root2);
+	void bind(uint32_t root, const Type& type);
+	bool occurs_in(uint32_t root, const Type& type);
+	void unify(const Type& t1, const Type& t2);
+};
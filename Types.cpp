@@ -0,0 +1,98 @@
+#include <mutex>
+#include <stdexcept>
+#include "Types.h"
+
+TypeInterner::TypeInterner() {
+	// Id 0 stays empty for the null type; the built-ins follow in TypeEnum order.
+	chunks[0] = std::make_unique<Chunk>();
+	count = 1;
+	for (const RealType& type : types) {
+		add(std::make_unique<TConstructor>(type));
+	}
+}
+
+Type TypeInterner::add(std::unique_ptr<TType> type) {
+	if (count >= MAX_TYPES) throw std::length_error{"Too many distinct types."};
+
+	auto& chunk{chunks[count / CHUNK_SIZE]};
+	if (chunk == nullptr) chunk = std::make_unique<Chunk>();
+	(*chunk)[count % CHUNK_SIZE] = std::move(type);
+	return Type{count++};
+}
+
+Type TypeInterner::constructor(const RealType& type, std::span<const Type> generics) {
+	int8_t index{token_type_index[(size_t)type.keyword.second]};
+	if (generics.empty() && index >= 0 && types[index] == type) return Type::of((TypeEnum)index);
+
+	std::vector<uint32_t> key{(uint32_t)type.keyword.second, type.size, type.is_signed};
+	for (Type generic : generics) key.push_back(generic.id);
+
+	{
+		std::shared_lock lock{mutex};
+		if (auto it{constructors.find(key)}; it != constructors.end()) return it->second;
+	}
+
+	std::unique_lock lock{mutex};
+	if (auto it{constructors.find(key)}; it != constructors.end()) return it->second;
+	Type t{add(std::make_unique<TConstructor>(type, generics))};
+	constructors.emplace(std::move(key), t);
+	return t;
+}
+
+Type TypeInterner::pointer_to(Type inner) {
+	{
+		std::shared_lock lock{mutex};
+		if (auto it{pointers.find(inner.id)}; it != pointers.end()) return it->second;
+	}
+
+	std::unique_lock lock{mutex};
+	if (auto it{pointers.find(inner.id)}; it != pointers.end()) return it->second;
+	Type t{add(std::make_unique<TPointer>(inner))};
+	pointers.emplace(inner.id, t);
+	return t;
+}
+
+Type TypeInterner::variable(uint32_t index) {
+	{
+		std::shared_lock lock{mutex};
+		if (index < variables.size()) return variables[index];
+	}
+
+	std::unique_lock lock{mutex};
+	while (variables.size() <= index) {
+		variables.push_back(add(std::make_unique<TVariable>((uint32_t)variables.size())));
+	}
+	return variables[index];
+}
+
+Type TypeInterner::parameter(Symbol name) {
+	{
+		std::shared_lock lock{mutex};
+		if (auto it{parameters.find(name)}; it != parameters.end()) return it->second;
+	}
+
+	std::unique_lock lock{mutex};
+	if (auto it{parameters.find(name)}; it != parameters.end()) return it->second;
+	Type t{add(std::make_unique<TParameter>(name))};
+	parameters.emplace(name, t);
+	return t;
+}
+
+TypeInterner& interned_types() {
+	// Function-local, so NATIVE_FUNCTIONS can intern during static initialization.
+	static TypeInterner interner{};
+	return interner;
+}
+
+std::string type_name(Type type) {
+	if (auto cons{type_cast<TConstructor>(type)}) {
+		return std::string{cons->type.keyword.first};
+	} else if (auto ptr{type_cast<TPointer>(type)}) {
+		return type_name(ptr->inner) + '*';
+	} else if (auto param{type_cast<TParameter>(type)}) {
+		return std::string{symbol_name(param->name)};
+	} else if (auto var{type_cast<TVariable>(type)}) {
+		return '$' + std::to_string(var->index);
+	}
+	return "auto";
+}
@@ -1,31 +1,76 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "Lexer.h"
 
+// Lets type_cast() check a type's class without RTTI.
+enum class TypeKind : uint8_t {
+	CONSTRUCTOR,
+	VARIABLE,
+	POINTER,
+	PARAMETER,
+};
+
+struct TType;
+
+// A type, named by its 32-bit id in the TypeInterner. Every distinct type
+// is interned once, so two Types are the same type exactly when their ids
+// are equal. Id 0 is no type, the way a null pointer was before.
+struct Type {
+	constexpr Type() = default;
+	constexpr Type(std::nullptr_t) { }
+	constexpr explicit Type(uint32_t id) : id{id} { }
+
+	// The built-in constructors are interned first and keep fixed ids.
+	static constexpr Type of(TypeEnum type) noexcept { return Type{(uint32_t)type + 1}; }
+	static Type constructor(const RealType& type, std::span<const Type> generics = {});
+	static Type pointer_to(Type inner);
+	static Type variable(uint32_t index);
+	static Type parameter(Symbol name);
+
+	const TType* operator->() const noexcept;
+	const TType& operator*() const noexcept { return *operator->(); }
+
+	constexpr bool operator==(const Type& type) const noexcept = default;
+	constexpr bool operator==(std::nullptr_t) const noexcept { return id == 0; }
+	constexpr explicit operator bool() const noexcept { return id != 0; }
+
+	uint32_t id{};
+};
+
 struct TType {
-	explicit TType() : size{(uint8_t)-1} { }
-	explicit TType(uint8_t size) : size{size} { }
+	explicit TType(TypeKind kind) : kind{kind}, size{(uint8_t)-1} { }
+	explicit TType(TypeKind kind, uint8_t size) : kind{kind}, size{size} { }
 	virtual ~TType() = default;
 
 	virtual void print() const noexcept { }
 
-	uint8_t get_size() { return size; }
+	uint8_t get_size() const noexcept { return size; }
 	virtual bool is_signed() const noexcept = 0;
 
+	const TypeKind kind;
+
 protected:
 	uint8_t size{};
 };
 
-using Type = std::shared_ptr<TType>;
-
 struct TConstructor : public TType {
-	TConstructor() : TType{} {}
+	static constexpr TypeKind KIND{TypeKind::CONSTRUCTOR};
+
+	TConstructor() : TType{KIND} {}
 	explicit TConstructor(const RealType& type)
-		: TType{type.size}, type{type} {}
-	explicit TConstructor(const RealType& type, const std::vector<Type>& generics)
-		: TType{type.size}, type{type}, generics{generics} {}
+		: TType{KIND, type.size}, type{type} {}
+	explicit TConstructor(const RealType& type, std::span<const Type> generics)
+		: TType{KIND, type.size}, type{type}, generics{generics.begin(), generics.end()} {}
 
 	bool operator==(const TConstructor& t) const noexcept {
 		return (type == t.type);
@@ -44,30 +89,23 @@ struct TConstructor : public TType {
 };
 
 struct TVariable : public TType {
-	TVariable() : TType{} {}
-	explicit TVariable(int idx) : TType{}, index{idx} {}
+	static constexpr TypeKind KIND{TypeKind::VARIABLE};
 
-	bool operator==(const TVariable& t) const noexcept {
-		return (index == t.index);
-	}
-	bool operator!=(const TVariable& t) const noexcept { return !(*this == t); }
+	TVariable() : TType{KIND} {}
+	explicit TVariable(uint32_t idx) : TType{KIND}, index{idx} {}
 
 	void print() const noexcept override { std::cout << "$" << index << std::endl; }
 
 	bool is_signed() const noexcept override { return false; }
 
-	int index{};
+	uint32_t index{};
 };
 
-static bool comp_types(const Type& t1, const Type& t2) noexcept;
-
 struct TPointer : public TType {
-	TPointer() : TType{sizeof(int*)} {}
-	explicit TPointer(const std::shared_ptr<TType>& t) : TType{sizeof(int*)}, inner{t} {}
+	static constexpr TypeKind KIND{TypeKind::POINTER};
 
-	bool operator==(const TPointer& t) const noexcept {
-		return comp_types(inner, t.inner);
-	}
+	TPointer() : TType{KIND, sizeof(int*)} {}
+	explicit TPointer(Type t) : TType{KIND, sizeof(int*)}, inner{t} {}
 
 	void print() const noexcept override {
 		std::cout << "pointer to ";
@@ -79,26 +117,80 @@ struct TPointer : public TType {
 	Type inner{};
 };
 
-static bool is_pointer(const Type& t) {
-	return std::dynamic_pointer_cast<TPointer>(t) != nullptr;
-}
+// A generic function's type parameter, by name. Only appears in what the
+// function declares; each instance replaces it with a type argument.
+struct TParameter : public TType {
+	static constexpr TypeKind KIND{TypeKind::PARAMETER};
 
-static bool comp_types(const Type& t1, const Type& t2) noexcept {
-	auto c1{std::dynamic_pointer_cast<TConstructor>(t1)};
-	auto c2{std::dynamic_pointer_cast<TConstructor>(t2)};
-	auto v1{std::dynamic_pointer_cast<TVariable>(t1)};
-	auto v2{std::dynamic_pointer_cast<TVariable>(t2)};
-	auto p1{std::dynamic_pointer_cast<TPointer>(t1)};
-	auto p2{std::dynamic_pointer_cast<TPointer>(t2)};
-
-	if (c1 != nullptr && c2 != nullptr) {
-		return (*c1 == *c2);
-	} else if (v1 != nullptr && v2 != nullptr) {
-		return (*v1 == *v2);
-	} else if (p1 != nullptr && p2 != nullptr) {
-		return (*p1 == *p2);
+	TParameter() : TType{KIND} {}
+	explicit TParameter(Symbol name) : TType{KIND}, name{name} {}
+
+	void print() const noexcept override { std::cout << symbol_name(name) << std::endl; }
+
+	bool is_signed() const noexcept override { return false; }
+
+	Symbol name{};
+};
+
+class TypeInterner {
+public:
+	static constexpr uint32_t MAX_TYPES{1u << 24};
+
+	TypeInterner();
+
+	Type constructor(const RealType& type, std::span<const Type> generics);
+	Type pointer_to(Type inner);
+	Type variable(uint32_t index);
+	Type parameter(Symbol name);
+
+	const TType* get(Type type) const noexcept {
+		return (*chunks[type.id / CHUNK_SIZE])[type.id % CHUNK_SIZE].get();
 	}
 
-	return false;
+private:
+	static constexpr uint32_t CHUNK_SIZE{4096};
+	using Chunk = std::array<std::unique_ptr<TType>, CHUNK_SIZE>;
+
+	Type add(std::unique_ptr<TType> type);
+
+	// Nodes never move once added, and a Type only exists after its node
+	// is in place, so get() reads without the lock. ParallelParser workers
+	// intern pointer types concurrently.
+	std::array<std::unique_ptr<Chunk>, MAX_TYPES / CHUNK_SIZE> chunks{};
+	uint32_t count{};
+
+	mutable std::shared_mutex mutex{};
+	std::unordered_map<uint32_t, Type> pointers{};
+	std::vector<Type> variables{};
+	std::unordered_map<Symbol, Type> parameters{};
+	// Constructors other than the built-ins, by kind token, size,
+	// signedness and generic ids.
+	std::map<std::vector<uint32_t>, Type> constructors{};
+};
+
+// The interner shared by every pass.
+TypeInterner& interned_types();
+
+inline const TType* Type::operator->() const noexcept { return interned_types().get(*this); }
+
+inline Type Type::constructor(const RealType& type, std::span<const Type> generics) {
+	return interned_types().constructor(type, generics);
+}
+inline Type Type::pointer_to(Type inner) { return interned_types().pointer_to(inner); }
+inline Type Type::variable(uint32_t index) { return interned_types().variable(index); }
+inline Type Type::parameter(Symbol name) { return interned_types().parameter(name); }
+
+// The type as a T if it is one, like dynamic_pointer_cast but without RTTI.
+template <typename T>
+const T* type_cast(Type t) noexcept {
+	if (t == nullptr) return nullptr;
+	const TType* type{t.operator->()};
+	return type->kind == T::KIND ? static_cast<const T*>(type) : nullptr;
+}
+
+static bool is_pointer(Type t) {
+	return type_cast<TPointer>(t) != nullptr;
 }
 
+// The type as it is written in source.
+std::string type_name(Type type);
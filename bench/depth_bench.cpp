@@ -0,0 +1,120 @@
+// Time and peak memory of the whole pipeline as nesting depth grows. Each
+// program runs in a forked child so its peak RSS can be read on its own.
+// Usage: depth_bench [max depth]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../Lexer.h"
+#include "../TokenStream.h"
+#include "../Parser.h"
+#include "../SemanticAnalyzer.h"
+#include "../SSABuilder.h"
+#include "../SSAOptimizer.h"
+#include "../IntermediateCodeGenerator.h"
+#include "../ASCodeGenerator.h"
+
+static std::string repeat(std::string_view s, size_t n) {
+	std::string out{};
+	out.reserve(s.size() * n);
+	for (size_t i{0}; i < n; i++) out += s;
+	return out;
+}
+
+static std::string in_main(const std::string& body) {
+	return "i32 main() {\n" + body + "\nreturn 0;\n}\n";
+}
+
+static std::string binary_chain(size_t depth) {
+	return in_main("i32 x = 1" + repeat(" + 1", depth) + ";");
+}
+
+static std::string right_chain(size_t depth) {
+	return in_main("i32 x = " + repeat("1 + (", depth) + "1" + repeat(")", depth) + ";");
+}
+
+static std::string nested_parens(size_t depth) {
+	return in_main("i32 x = " + repeat("(", depth) + "1" + repeat(")", depth) + ";");
+}
+
+static std::string unary_chain(size_t depth) {
+	return in_main("i32 x = " + repeat("- ", depth) + "1;");
+}
+
+static std::string nested_blocks(size_t depth) {
+	return in_main(repeat("{ ", depth) + "i32 x = 1;" + repeat(" };", depth));
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point begin) {
+	return std::chrono::duration<double>{std::chrono::steady_clock::now() - begin}.count();
+}
+
+static void compile(const std::string& source) {
+	auto arena{std::make_unique<Arena>()};
+	auto begin{std::chrono::steady_clock::now()};
+	Lexer lexer{source};
+	TokenStream toks{lexer};
+	Parser parser{toks, *arena};
+	auto stmts{parser.run()};
+	double parse{seconds_since(begin)};
+
+	double analyze{}, generate{};
+	size_t lines{};
+	{
+		begin = std::chrono::steady_clock::now();
+		SemanticAnalyzer analyzer{stmts, *arena};
+		bool checked{analyzer.infer() && analyzer.check()};
+		analyze = seconds_since(begin);
+
+		begin = std::chrono::steady_clock::now();
+		if (checked) {
+			SSAModule module{SSABuilder{stmts}.run()};
+			SSAOptimizer{module}.run();
+			auto ir{IntermediateCodeGenerator{module}.run()};
+			lines = ASCodeGenerator{ir}.run().size();
+		}
+		generate = seconds_since(begin);
+	}
+
+	begin = std::chrono::steady_clock::now();
+	arena.reset();
+	double teardown{seconds_since(begin)};
+
+	std::cout << "parse " << parse * 1e3 << " ms, analyze " << analyze * 1e3
+		<< " ms, generate " << generate * 1e3 << " ms, teardown " << teardown * 1e3
+		<< " ms, " << lines << " asm lines";
+}
+
+static void bench(const char* name, std::string (*generate)(size_t), size_t max_depth) {
+	for (size_t depth{1000}; depth <= max_depth; depth *= 10) {
+		std::string source{generate(depth)};
+		std::cout << name << ' ' << depth << ": " << std::flush;
+
+		pid_t child{fork()};
+		if (child == 0) {
+			compile(source);
+			std::cout << std::flush;
+			_exit(0);
+		}
+
+		int status{};
+		rusage usage{};
+		wait4(child, &status, 0, &usage);
+		if (!WIFEXITED(status)) std::cout << "crashed";
+		std::cout << ", peak " << usage.ru_maxrss / 1024 << " MB\n";
+	}
+}
+
+int main(int argc, char** argv) {
+	size_t max_depth{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000u};
+	bench("binary", binary_chain, max_depth);
+	bench("right", right_chain, max_depth);
+	bench("parens", nested_parens, max_depth);
+	bench("unary", unary_chain, max_depth);
+	bench("blocks", nested_blocks, max_depth);
+	return 0;
+}
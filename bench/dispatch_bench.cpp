@@ -0,0 +1,177 @@
+// Time per AST node of each pass over one generated program, plus a bare
+// walk of the tree dispatching on node tags against the same walk trying
+// dynamic_cast on each node type in turn.
+// Usage: dispatch_bench [functions]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../Lexer.h"
+#include "../TokenStream.h"
+#include "../Parser.h"
+#include "../SemanticAnalyzer.h"
+#include "../SSABuilder.h"
+#include "../SSAOptimizer.h"
+#include "../IntermediateCodeGenerator.h"
+#include "../ASCodeGenerator.h"
+
+static std::string many_functions(size_t count) {
+	std::string out{"i64 generated_function_0(i64 a, i64 b) {\n\treturn a;\n}\n\n"};
+	for (size_t i{1}; i < count; i++) {
+		std::string n{std::to_string(i)};
+		out += "i64 generated_function_" + n + "(i64 a, i64 b) {\n"
+			"\ti64 x = a * 3i64 + b - " + n + "i64;\n"
+			"\t{\n\t\ti64 y = (x + a) * (x - b);\n\t\tx = y / 2i64;\n\t};\n"
+			"\treturn x + generated_function_" + std::to_string(i - 1) + "(b, a);\n"
+			"}\n\n";
+	}
+	return out + "i32 main() {\n\treturn 0;\n}\n";
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point begin) {
+	return std::chrono::duration<double>{std::chrono::steady_clock::now() - begin}.count();
+}
+
+static size_t tag_walk(Statement* stmt);
+
+static size_t tag_walk(Expression* expr) {
+	if (expr == nullptr) return 0;
+	return 1 + visit(expr, overloaded{
+		[](UnaryExpression* un) { return tag_walk(un->expr); },
+		[](BinaryExpression* bin) { return tag_walk(bin->sides.first) + tag_walk(bin->sides.second); },
+		[](GroupingExpression* group) { return tag_walk(group->expr); },
+		[](BlockExpression* block) {
+			size_t count{};
+			for (Statement* stmt : block->statements) count += tag_walk(stmt);
+			return count;
+		},
+		[](CallExpression* call) {
+			size_t count{tag_walk(call->callee)};
+			for (Expression* arg : call->args) count += tag_walk(arg);
+			return count;
+		},
+		[](ReturnExpression* ret) { return tag_walk(ret->return_expression); },
+		[](CastExpression* cast) { return tag_walk(cast->expr); },
+		[](auto*) { return size_t{0}; },
+	});
+}
+
+static size_t tag_walk(Statement* stmt) {
+	return 1 + visit(stmt, overloaded{
+		[](ExpressionStatement* expr) { return tag_walk(expr->expr); },
+		[](VariableDeclarationStatement* decl) { return tag_walk(decl->identifier) + tag_walk(decl->initializer); },
+		[](FunctionDeclarationStatement* decl) { return tag_walk(decl->identifier) + tag_walk(decl->block); },
+	});
+}
+
+// The dispatch the passes used before node kinds, for comparison.
+static size_t cast_walk(Statement* stmt);
+
+static size_t cast_walk(Expression* expr) {
+	if (expr == nullptr) return 0;
+	if (dynamic_cast<IdentifierExpression*>(expr)) {
+		return 1;
+	} else if (dynamic_cast<LiteralExpression*>(expr)) {
+		return 1;
+	} else if (auto group{dynamic_cast<GroupingExpression*>(expr)}) {
+		return 1 + cast_walk(group->expr);
+	} else if (auto un{dynamic_cast<UnaryExpression*>(expr)}) {
+		return 1 + cast_walk(un->expr);
+	} else if (auto bin{dynamic_cast<BinaryExpression*>(expr)}) {
+		return 1 + cast_walk(bin->sides.first) + cast_walk(bin->sides.second);
+	} else if (auto block{dynamic_cast<BlockExpression*>(expr)}) {
+		size_t count{1};
+		for (Statement* stmt : block->statements) count += cast_walk(stmt);
+		return count;
+	} else if (auto call{dynamic_cast<CallExpression*>(expr)}) {
+		size_t count{1 + cast_walk(call->callee)};
+		for (Expression* arg : call->args) count += cast_walk(arg);
+		return count;
+	} else if (auto ret{dynamic_cast<ReturnExpression*>(expr)}) {
+		return 1 + cast_walk(ret->return_expression);
+	} else if (auto cast{dynamic_cast<CastExpression*>(expr)}) {
+		return 1 + cast_walk(cast->expr);
+	}
+	return 1;
+}
+
+static size_t cast_walk(Statement* stmt) {
+	if (auto expr{dynamic_cast<ExpressionStatement*>(stmt)}) {
+		return 1 + cast_walk(expr->expr);
+	} else if (auto decl{dynamic_cast<VariableDeclarationStatement*>(stmt)}) {
+		return 1 + cast_walk(decl->identifier) + cast_walk(decl->initializer);
+	} else if (auto decl{dynamic_cast<FunctionDeclarationStatement*>(stmt)}) {
+		return 1 + cast_walk(decl->identifier) + cast_walk(decl->block);
+	}
+	return 1;
+}
+
+template <typename F>
+static double best_walk(const std::vector<Statement*>& stmts, size_t nodes, F walk) {
+	double best{};
+	for (int run{0}; run < 5; run++) {
+		auto begin{std::chrono::steady_clock::now()};
+		size_t count{};
+		for (Statement* stmt : stmts) count += walk(stmt);
+		double t{seconds_since(begin)};
+		if (run == 0 || t < best) best = t;
+		if (count != nodes) std::cout << "walk saw " << count << " of " << nodes << " nodes\n";
+	}
+	return best;
+}
+
+int main(int argc, char** argv) {
+	size_t functions{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000u};
+	std::string source{many_functions(functions)};
+
+	Arena arena{};
+	auto begin{std::chrono::steady_clock::now()};
+	Lexer lexer{source};
+	TokenStream toks{lexer};
+	Parser parser{toks, arena};
+	auto stmts{parser.run()};
+	double parse{seconds_since(begin)};
+
+	size_t nodes{};
+	for (Statement* stmt : stmts) nodes += tag_walk(stmt);
+	double tags{best_walk(stmts, nodes, [](Statement* stmt) { return tag_walk(stmt); })};
+	double casts{best_walk(stmts, nodes, [](Statement* stmt) { return cast_walk(stmt); })};
+
+	begin = std::chrono::steady_clock::now();
+	SemanticAnalyzer analyzer{stmts, arena};
+	bool typed{analyzer.infer()};
+	double type{seconds_since(begin)};
+
+	begin = std::chrono::steady_clock::now();
+	bool checked{typed && analyzer.check()};
+	double environment{seconds_since(begin)};
+	if (!checked) {
+		std::cout << "generated program did not check\n";
+		return 1;
+	}
+
+	begin = std::chrono::steady_clock::now();
+	SSAModule module{SSABuilder{stmts}.run()};
+	SSAOptimizer{module}.run();
+	IntermediateCodeGenerator icg{module};
+	auto ir{icg.run()};
+	double intermediate{seconds_since(begin)};
+
+	begin = std::chrono::steady_clock::now();
+	ASCodeGenerator as{ir};
+	as.run();
+	double assembly{seconds_since(begin)};
+
+	auto per_node{[&](double seconds) { return seconds * 1e9 / nodes; }};
+	std::cout << nodes << " nodes, ns per node:\n"
+		<< "  tag walk       " << per_node(tags) << "\n"
+		<< "  cast walk      " << per_node(casts) << "\n"
+		<< "  parse          " << per_node(parse) << "\n"
+		<< "  type analysis  " << per_node(type) << "\n"
+		<< "  environment    " << per_node(environment) << "\n"
+		<< "  intermediate   " << per_node(intermediate) << "\n"
+		<< "  assembly       " << per_node(assembly) << "\n"
+		<< "  pipeline       " << per_node(parse + type + environment + intermediate + assembly) << "\n";
+	return 0;
+}
@@ -0,0 +1,142 @@
+// Passes that only look at types or at one node kind, run over the pointer
+// AST and over its FlatAst copy. Times are per expression, best of five.
+// Usage: flat_ast_bench [functions]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../Lexer.h"
+#include "../TokenStream.h"
+#include "../Parser.h"
+#include "../SemanticAnalyzer.h"
+#include "../FlatAst.h"
+
+static std::string many_functions(size_t count) {
+	std::string out{"i64 generated_function_0(i64 a, i64 b) {\n\treturn a;\n}\n\n"};
+	for (size_t i{1}; i < count; i++) {
+		std::string n{std::to_string(i)};
+		out += "i64 generated_function_" + n + "(i64 a, i64 b) {\n"
+			"\ti64 x = a * 3i64 + b - " + n + "i64;\n"
+			"\t{\n\t\ti64 y = (x + a) * (x - b);\n\t\tx = y / 2i64;\n\t};\n"
+			"\treturn x + generated_function_" + std::to_string(i - 1) + "(b, a);\n"
+			"}\n\n";
+	}
+	return out;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point begin) {
+	return std::chrono::duration<double>{std::chrono::steady_clock::now() - begin}.count();
+}
+
+template <typename F>
+static double best_of_five(F f) {
+	double best{};
+	for (int run{0}; run < 5; run++) {
+		auto begin{std::chrono::steady_clock::now()};
+		f();
+		double t{seconds_since(begin)};
+		if (run == 0 || t < best) best = t;
+	}
+	return best;
+}
+
+// Calls `f` on every expression under `stmt`, parents first.
+template <typename F>
+static void each_expression(Statement* stmt, F& f);
+
+template <typename F>
+static void each_expression(Expression* expr, F& f) {
+	if (expr == nullptr) return;
+	f(expr);
+	visit(expr, overloaded{
+		[&](UnaryExpression* un) { each_expression(un->expr, f); },
+		[&](BinaryExpression* bin) {
+			each_expression(bin->sides.first, f);
+			each_expression(bin->sides.second, f);
+		},
+		[&](GroupingExpression* group) { each_expression(group->expr, f); },
+		[&](BlockExpression* block) {
+			for (Statement* stmt : block->statements) each_expression(stmt, f);
+		},
+		[&](CallExpression* call) {
+			each_expression(call->callee, f);
+			for (Expression* arg : call->args) each_expression(arg, f);
+		},
+		[&](ReturnExpression* ret) { each_expression(ret->return_expression, f); },
+		[&](CastExpression* cast) { each_expression(cast->expr, f); },
+		[](auto*) { },
+	});
+}
+
+template <typename F>
+static void each_expression(Statement* stmt, F& f) {
+	visit(stmt, overloaded{
+		[&](ExpressionStatement* expr) { each_expression(expr->expr, f); },
+		[&](VariableDeclarationStatement* decl) {
+			each_expression(decl->identifier, f);
+			each_expression(decl->initializer, f);
+		},
+		[&](FunctionDeclarationStatement* decl) {
+			each_expression(decl->identifier, f);
+			each_expression(decl->block, f);
+		},
+	});
+}
+
+int main(int argc, char** argv) {
+	size_t functions{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000u};
+	std::string source{many_functions(functions)};
+
+	Arena arena{};
+	Lexer lexer{source};
+	TokenStream toks{lexer};
+	Parser parser{toks, arena};
+	auto stmts{parser.run()};
+	SemanticAnalyzer analyzer{stmts, arena};
+	analyzer.infer();
+
+	FlatAst ast{};
+	double flatten{best_of_five([&] { ast = FlatAst::flatten(stmts); })};
+	double nodes{(double)ast.expression_count()};
+
+	// How many expressions have a signed type.
+	size_t pointer_signed{}, flat_signed{};
+	double pointer_types{best_of_five([&] {
+		pointer_signed = 0;
+		auto count{[&](Expression* expr) { pointer_signed += expr->type != nullptr && expr->type->is_signed(); }};
+		for (Statement* stmt : stmts) each_expression(stmt, count);
+	})};
+	double flat_types{best_of_five([&] {
+		flat_signed = 0;
+		for (const Type& type : ast.types) flat_signed += type != nullptr && type->is_signed();
+	})};
+
+	// How many binary expressions add.
+	size_t pointer_adds{}, flat_adds{};
+	double pointer_kind{best_of_five([&] {
+		pointer_adds = 0;
+		auto count{[&](Expression* expr) {
+			if (auto bin{node_cast<BinaryExpression>(expr)}) pointer_adds += bin->op.type == TokenType::PLUS;
+		}};
+		for (Statement* stmt : stmts) each_expression(stmt, count);
+	})};
+	double flat_kind{best_of_five([&] {
+		flat_adds = 0;
+		for (const FlatAst::Binary& bin : ast.binaries) flat_adds += bin.op.type == TokenType::PLUS;
+	})};
+
+	if (pointer_signed != flat_signed || pointer_adds != flat_adds) {
+		std::cout << "pointer and flat walks disagree\n";
+		return 1;
+	}
+
+	auto per_node{[&](double seconds) { return seconds * 1e9 / nodes; }};
+	std::cout << (size_t)nodes << " expressions, ns per expression:\n"
+		<< "  flatten             " << per_node(flatten) << "\n"
+		<< "  types, pointer AST  " << per_node(pointer_types) << "\n"
+		<< "  types, flat AST     " << per_node(flat_types) << "\n"
+		<< "  adds, pointer AST   " << per_node(pointer_kind) << "\n"
+		<< "  adds, flat AST      " << per_node(flat_kind) << "\n";
+	return 0;
+}
@@ -0,0 +1,62 @@
+// Heap allocations and time of the front end (lexing and parsing) and of
+// freeing the tree, on one large generated file.
+// Usage: frontend_alloc_bench [functions]
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include "../ParallelParser.h"
+
+static std::atomic<size_t> allocations{};
+
+void* operator new(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p{std::malloc(size != 0 ? size : 1)}) return p;
+	throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static std::string many_functions(size_t count) {
+	std::string out{"i64 generated_function_0(i64 a, i64 b) {\n\treturn a;\n}\n\n"};
+	for (size_t i{1}; i < count; i++) {
+		std::string n{std::to_string(i)};
+		out += "i64 generated_function_" + n + "(i64 a, i64 b) {\n"
+			"\ti64 x = a * 3i64 + b - " + n + "i64;\n"
+			"\t{\n\t\ti64 y = (x + a) * (x - b);\n\t\tx = y / 2i64;\n\t};\n"
+			"\treturn x + generated_function_" + std::to_string(i - 1) + "(b, a);\n"
+			"}\n\n";
+	}
+	return out;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point begin) {
+	return std::chrono::duration<double>{std::chrono::steady_clock::now() - begin}.count();
+}
+
+int main(int argc, char** argv) {
+	size_t functions{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000u};
+	std::string source{many_functions(functions)};
+
+	for (int run{0}; run < 3; run++) {
+		auto arena{std::make_unique<Arena>()};
+
+		size_t before{allocations.load()};
+		auto begin{std::chrono::steady_clock::now()};
+		auto stmts{ParallelParser{source, 1, *arena}.run()};
+		double parse{seconds_since(begin)};
+		size_t parse_allocations{allocations.load() - before};
+
+		begin = std::chrono::steady_clock::now();
+		arena.reset();
+		double teardown{seconds_since(begin)};
+
+		std::cout << "run " << run << ": front end " << parse * 1e3 << " ms, "
+			<< parse_allocations << " allocations (" << (double)parse_allocations / stmts.size()
+			<< " per function), teardown " << teardown * 1e3 << " ms\n";
+	}
+	return 0;
+}
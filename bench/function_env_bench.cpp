@@ -0,0 +1,55 @@
+// Type and environment analysis time per function as the number of
+// top-level functions grows. Each body is entered with every earlier
+// function in scope, so the time per function should stay flat.
+// Usage: function_env_bench [max functions]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../Lexer.h"
+#include "../TokenStream.h"
+#include "../Parser.h"
+#include "../SemanticAnalyzer.h"
+
+static std::string many_functions(size_t count) {
+	std::string out{"i64 generated_function_0(i64 a, i64 b) {\n\treturn a;\n}\n\n"};
+	for (size_t i{1}; i < count; i++) {
+		std::string n{std::to_string(i)};
+		out += "i64 generated_function_" + n + "(i64 a, i64 b) {\n"
+			"\ti64 x = a * 3i64 + b - " + n + "i64;\n"
+			"\treturn x + generated_function_" + std::to_string(i - 1) + "(b, a);\n"
+			"}\n\n";
+	}
+	return out;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point begin) {
+	return std::chrono::duration<double>{std::chrono::steady_clock::now() - begin}.count();
+}
+
+int main(int argc, char** argv) {
+	size_t max_functions{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16000u};
+	for (size_t functions{1000}; functions <= max_functions; functions *= 2) {
+		std::string source{many_functions(functions)};
+		Arena arena{};
+		Lexer lexer{source};
+		TokenStream toks{lexer};
+		Parser parser{toks, arena};
+		auto stmts{parser.run()};
+
+		auto begin{std::chrono::steady_clock::now()};
+		SemanticAnalyzer analyzer{stmts, arena};
+		bool typed{analyzer.infer()};
+		double type{seconds_since(begin)};
+
+		begin = std::chrono::steady_clock::now();
+		bool checked{typed && analyzer.check()};
+		double environment{seconds_since(begin)};
+
+		std::cout << functions << " functions: type analysis " << type * 1e6 / functions
+			<< " us, environment " << environment * 1e6 / functions << " us per function"
+			<< (checked ? "" : " (did not check)") << "\n";
+	}
+	return 0;
+}
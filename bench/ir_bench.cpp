@@ -0,0 +1,66 @@
+// Intermediate code generation per function as programs grow: building
+// SSA, optimizing it and lowering it. Each function writes a string, so
+// the module collects string data as it goes; the time per function should
+// stay flat.
+// Usage: ir_bench [max functions]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../Lexer.h"
+#include "../TokenStream.h"
+#include "../Parser.h"
+#include "../SemanticAnalyzer.h"
+#include "../SSABuilder.h"
+#include "../SSAOptimizer.h"
+#include "../IntermediateCodeGenerator.h"
+
+static std::string many_functions(size_t count) {
+	std::string out{};
+	for (size_t i{0}; i < count; i++) {
+		std::string n{std::to_string(i)};
+		out += "i64 generated_function_" + n + "(i64 a, i64 b) {\n"
+			"\twrite(1, \"" + n + "\\n\", " + std::to_string(n.size() + 1) + ");\n"
+			"\ti64 x = a + b - " + n + "i64;\n"
+			"\treturn x + b;\n"
+			"}\n\n";
+	}
+	return out + "i32 main() {\n\treturn 0;\n}\n";
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point begin) {
+	return std::chrono::duration<double>{std::chrono::steady_clock::now() - begin}.count();
+}
+
+int main(int argc, char** argv) {
+	size_t max_functions{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64000u};
+	for (size_t functions{1000}; functions <= max_functions; functions *= 2) {
+		std::string source{many_functions(functions)};
+		Arena arena{};
+		Lexer lexer{source};
+		TokenStream toks{lexer};
+		auto stmts{Parser{toks, arena}.run()};
+		SemanticAnalyzer analyzer{stmts, arena};
+		bool ok{analyzer.infer() && analyzer.check()};
+		stmts = analyzer.program();
+
+		auto begin{std::chrono::steady_clock::now()};
+		SSAModule module{SSABuilder{stmts}.run()};
+		double build{seconds_since(begin)};
+
+		begin = std::chrono::steady_clock::now();
+		SSAOptimizer{module}.run();
+		double optimize{seconds_since(begin)};
+
+		begin = std::chrono::steady_clock::now();
+		auto ir{IntermediateCodeGenerator{module}.run()};
+		double lower{seconds_since(begin)};
+
+		auto per_function{[&](double seconds) { return seconds * 1e6 / functions; }};
+		std::cout << functions << " functions, us per function: build " << per_function(build)
+			<< ", optimize " << per_function(optimize) << ", lower " << per_function(lower) << ", "
+			<< ir.commands.size() << " commands" << (ok ? "" : " (did not check)") << "\n";
+	}
+	return 0;
+}
@@ -0,0 +1,59 @@
+// Lexer throughput for each scan mode the CPU supports.
+// Usage: lexer_bench [megabytes]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../Lexer.h"
+#include "../Scan.h"
+
+static std::string identifier_heavy(size_t bytes) {
+	std::string out{};
+	for (size_t i{0}; out.size() < bytes; i++) {
+		out += "i64 a_rather_long_generated_identifier_" + std::to_string(i) +
+			" = another_generated_identifier_name_" + std::to_string(i) + " + 123456789;\n";
+	}
+	return out;
+}
+
+static std::string comment_heavy(size_t bytes) {
+	std::string out{};
+	while (out.size() < bytes) {
+		out += "        // generated comment that the lexer has to skip over entirely\n"
+			"        x = y;\n";
+	}
+	return out;
+}
+
+static void bench(const char* name, const std::string& source) {
+	static const char* mode_names[]{"scalar", "sse2", "avx2"};
+	size_t reference{};
+	for (ScanMode mode : {ScanMode::SCALAR, ScanMode::SSE2, ScanMode::AVX2}) {
+		if (set_scan_mode(mode) != mode) continue;
+
+		// Best of three, so page faults from the first token vector don't count.
+		size_t count{};
+		double best{};
+		for (int run{0}; run < 3; run++) {
+			auto begin{std::chrono::steady_clock::now()};
+			Lexer lexer{source};
+			count = lexer.run().size();
+			std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - begin};
+			if (run == 0 || elapsed.count() < best) best = elapsed.count();
+		}
+
+		if (reference == 0) reference = count;
+		if (count != reference) std::cerr << "token count mismatch in " << mode_names[(int)mode] << '\n';
+
+		std::cout << name << ' ' << mode_names[(int)mode] << ": "
+			<< source.size() / best / (1 << 20) << " MB/s (" << count << " tokens)\n";
+	}
+}
+
+int main(int argc, char** argv) {
+	size_t megabytes{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64u};
+	bench("identifiers", identifier_heavy(megabytes << 20));
+	bench("comments", comment_heavy(megabytes << 20));
+	return 0;
+}
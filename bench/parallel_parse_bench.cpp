@@ -0,0 +1,50 @@
+// Front-end time for one large generated file as the thread count grows.
+// Usage: parallel_parse_bench [functions]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "../ParallelParser.h"
+
+static std::string many_functions(size_t count) {
+	std::string out{"i64 generated_function_0(i64 a, i64 b) {\n\treturn a;\n}\n\n"};
+	for (size_t i{1}; i < count; i++) {
+		std::string n{std::to_string(i)};
+		out += "i64 generated_function_" + n + "(i64 a, i64 b) {\n"
+			"\t// generated body\n"
+			"\ti64 x = a * 3i64 + b - " + n + "i64;\n"
+			"\t{\n\t\ti64 y = (x + a) * (x - b);\n\t\tx = y / 2i64;\n\t};\n"
+			"\treturn x + generated_function_" + std::to_string(i - 1) + "(b, a);\n"
+			"}\n\n";
+	}
+	return out;
+}
+
+int main(int argc, char** argv) {
+	size_t functions{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000u};
+	std::string source{many_functions(functions)};
+	unsigned int cores{std::max(std::thread::hardware_concurrency(), 1u)};
+
+	double single{};
+	for (unsigned int jobs{1}; jobs <= cores; jobs = (jobs * 2 > cores && jobs < cores ? cores : jobs * 2)) {
+		// Best of three; the tree is freed outside the timed region.
+		double best{};
+		size_t count{};
+		for (int run{0}; run < 3; run++) {
+			Arena arena{};
+			auto begin{std::chrono::steady_clock::now()};
+			auto stmts{ParallelParser{source, jobs, arena}.run()};
+			std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - begin};
+			count = stmts.size();
+			if (run == 0 || elapsed.count() < best) best = elapsed.count();
+		}
+		if (jobs == 1) single = best;
+
+		std::cout << jobs << " jobs: " << best * 1e3 << " ms, " << source.size() / best / (1 << 20)
+			<< " MB/s, speedup " << single / best << " (" << count << " statements)\n";
+	}
+	return 0;
+}
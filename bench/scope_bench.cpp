@@ -0,0 +1,85 @@
+// Identifier lookups in EnvironmentStack as scope depth and symbol count
+// grow, against the stack of ordered sets the analyzers searched before.
+// Every lookup hits a symbol declared somewhere in the open scopes.
+// Usage: scope_bench [lookups]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include "../Environment.h"
+
+// The old layout: one pair of sets per scope, searched outermost first.
+struct SetStack {
+	struct Scope {
+		std::set<Variable, std::less<>> variables{};
+		std::set<Function, std::less<>> functions{};
+	};
+
+	std::optional<Type> get_identifier_type(const Token& identifier) const {
+		for (const auto& scope : scopes) {
+			if (auto var{scope.variables.find(identifier.symbol)}; var != scope.variables.end()) return var->type;
+		}
+		for (const auto& scope : scopes) {
+			if (auto func{scope.functions.find(identifier.symbol)}; func != scope.functions.end()) return func->return_type;
+		}
+		return std::nullopt;
+	}
+
+	std::vector<Scope> scopes{Scope{{}, NATIVE_FUNCTIONS}};
+};
+
+static double seconds_since(std::chrono::steady_clock::time_point begin) {
+	return std::chrono::duration<double>{std::chrono::steady_clock::now() - begin}.count();
+}
+
+template <typename Stack>
+static double time_lookups(const Stack& stack, const std::vector<Token>& queries, size_t lookups) {
+	size_t found{};
+	auto begin{std::chrono::steady_clock::now()};
+	for (size_t i{0}; i < lookups; i++) {
+		found += stack.get_identifier_type(queries[i % queries.size()]).has_value();
+	}
+	double t{seconds_since(begin)};
+	if (found != lookups) std::cout << "(missed " << lookups - found << ") ";
+	return t * 1e9 / lookups;
+}
+
+int main(int argc, char** argv) {
+	size_t lookups{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000u};
+	std::deque<std::string> names{};
+	Type i64{Type::of(TypeEnum::I64)};
+
+	std::cout << "ns per lookup\n";
+	for (size_t depth : {1, 8, 64, 512}) {
+		for (size_t symbols : {16, 256, 4096}) {
+			if (symbols < depth) continue;
+
+			EnvironmentStack env_stack{};
+			SetStack set_stack{};
+			std::vector<Token> declared{};
+			for (size_t scope{0}; scope < depth; scope++) {
+				env_stack.push();
+				set_stack.scopes.emplace_back();
+				for (size_t i{0}; i < symbols / depth; i++) {
+					names.push_back("v" + std::to_string(depth) + "_" + std::to_string(declared.size()));
+					Token name{names.back()};
+					env_stack.declare(Variable{i64, name});
+					set_stack.scopes.back().variables.insert(Variable{i64, name});
+					declared.push_back(name);
+				}
+			}
+
+			std::vector<Token> queries{declared};
+			std::shuffle(queries.begin(), queries.end(), std::mt19937{42});
+
+			std::cout << "depth " << depth << ", " << declared.size() << " symbols: scoped table "
+				<< time_lookups(env_stack, queries, lookups) << ", set stack "
+				<< time_lookups(set_stack, queries, lookups) << "\n";
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,49 @@
+// Type analysis of one function whose declarations are all inferred: each
+// `auto` variable is the previous one plus an unsuffixed literal, and only
+// the first literal carries a type. Every type variable ends up in a
+// single class, so solving should stay linear in the number of them.
+// Usage: unify_bench [max declarations]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../Lexer.h"
+#include "../TokenStream.h"
+#include "../Parser.h"
+#include "../SemanticAnalyzer.h"
+
+static std::string inferred_chain(size_t count) {
+	std::string out{"i64 main() {\n\tauto v0 = 1i64;\n"};
+	for (size_t i{1}; i < count; i++) {
+		out += "\tauto v" + std::to_string(i) + " = v" + std::to_string(i - 1) + " + " + std::to_string(i % 100) + ";\n";
+	}
+	out += "\treturn v" + std::to_string(count - 1) + ";\n}\n";
+	return out;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point begin) {
+	return std::chrono::duration<double>{std::chrono::steady_clock::now() - begin}.count();
+}
+
+int main(int argc, char** argv) {
+	size_t max_declarations{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000u};
+	for (size_t declarations{12500}; declarations <= max_declarations; declarations *= 2) {
+		std::string source{inferred_chain(declarations)};
+		Arena arena{};
+		Lexer lexer{source};
+		TokenStream toks{lexer};
+		Parser parser{toks, arena};
+		auto stmts{parser.run()};
+
+		auto begin{std::chrono::steady_clock::now()};
+		SemanticAnalyzer analyzer{stmts, arena};
+		bool typed{analyzer.infer()};
+		double type{seconds_since(begin)};
+
+		std::cout << declarations << " declarations (" << 2 * declarations - 1 << " literals and variables): "
+			<< type * 1e3 << " ms, " << type * 1e9 / declarations << " ns per declaration"
+			<< (typed ? "" : " (did not type)") << "\n";
+	}
+	return 0;
+}
@@ -1,9 +1,25 @@
+#include <algorithm>
+#include <cstdlib>
+#include <string_view>
+#include <thread>
 #include "ROC.h"
 
-int main() {
-	ROC roc{};
+// roc [-j[N]] [file]: -jN lexes and parses on N threads, -j alone on every core.
+int main(int argc, char** argv) {
+	unsigned int jobs{1};
+	const char* path{"code"};
+	for (int i{1}; i < argc; i++) {
+		std::string_view arg{argv[i]};
+		if (arg.starts_with("-j")) {
+			jobs = (arg.size() > 2 ? std::max(std::atoi(argv[i] + 2), 1) : std::max(std::thread::hardware_concurrency(), 1u));
+		} else {
+			path = argv[i];
+		}
+	}
 
-	roc.run(std::ifstream{"code"});
+	ROC roc{jobs};
+
+	roc.run(SourceFile{path});
 	/*std::string line{};
 	while (true) {
 		std::cout << "> ";
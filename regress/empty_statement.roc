@@ -0,0 +1,4 @@
+i32 main() {
+	;
+	return 0;
+}